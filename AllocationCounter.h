@@ -0,0 +1,18 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Counts heap allocations (every global operator new, on any thread).
+// The counting operator new itself is defined once, in project-rts.cpp; the game
+// samples the count around each frame to see how many allocations it made.
+class AllocationCounter {
+public:
+    static void record() { counter().fetch_add(1, std::memory_order_relaxed); }
+    static uint64_t get() { return counter().load(std::memory_order_relaxed); }
+
+private:
+    static std::atomic<uint64_t>& counter() {
+        static std::atomic<uint64_t> count(0);
+        return count;
+    }
+};
@@ -5,6 +5,8 @@
 #include <stdexcept>
 #include "Unit.h" 
 
+HandleTable<Building> Building::Handles;
+
 Building::Building(BuildingType type, const glm::vec3& pos, int teamID, const std::string& meshPath)
     : type_(type), position_(pos), teamID_(teamID), mesh_(nullptr),
     currentHealth_(100.0f), buildProgress_(0.0f), isConstructed_(false)
@@ -81,10 +83,14 @@ Building::Building(BuildingType type, const glm::vec3& pos, int teamID, const st
 
     // Center position (for model matrix)
     position_.y += scale * 0.5f;
+
+    // Last, so a constructor that throws never leaves a slot behind
+    handle_ = Handles.add(this);
 }
 
 Building::~Building()
 {
+    Handles.remove(handle_);
     delete mesh_;
     mesh_ = nullptr;
 }
@@ -3,10 +3,14 @@
 #include <GL/glew.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <string>
+#include "HandleTable.h"
 
 class Mesh;
 
 enum class UnitType;
+class Building;
+
+typedef Handle<Building> BuildingHandle;
 
 enum class BuildingType {
     TOWN_CENTER,
@@ -32,6 +36,9 @@ public:
     Building(BuildingType type, const glm::vec3& pos, int teamID, const std::string& meshPath = "");
     ~Building();
 
+    Building(const Building&) = delete;
+    Building& operator=(const Building&) = delete;
+
     void draw(const glm::mat4& view, const glm::mat4& projection,
         GLuint shaderProgram, float passedAlpha,
         glm::vec3 tint = glm::vec3(0.8f, 0.8f, 0.8f)); 
@@ -51,6 +58,10 @@ public:
     bool isConstructed() const { return isConstructed_; }
     const BuildingStats& getStats() const { return stats_; }
 
+    // Handle that stays safe to hold after we are destroyed (resolves to nullptr then)
+    BuildingHandle getHandle() const { return handle_; }
+    static Building* resolve(BuildingHandle h) { return Handles.get(h); }
+
     // Team Logic
     int getTeam() const { return teamID_; }
     bool isDead() const { return currentHealth_ <= 0; }
@@ -74,6 +85,9 @@ public:
     static ResourceCost getStaticCost(BuildingType type);
 
 private:
+    static HandleTable<Building> Handles;
+    BuildingHandle handle_;
+
     BuildingType type_;
     glm::vec3 position_;
     Mesh* mesh_;
@@ -0,0 +1,176 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "NavigationGrid.h"
+#include "Pathfinder.h"
+#include "SearchArena.h"
+
+// Per-unit planner for chasing a moving target.
+// It keeps the route from the last search. When the target has only taken a few
+// steps, a small search runs backwards from the target's new cell until it meets
+// the rest of that route. The new path is the old one up to the meeting point plus
+// the short new piece, smoothed again. That repair costs a few dozen expansions
+// where a fresh search costs hundreds.
+// A fresh search (Pathfinder::findPath) runs instead when the target jumped too
+// far, when we strayed off the old route, when the map blocked part of it, or after
+// MAX_REPAIRS repairs in a row so detours cannot pile up.
+// A unit may have a cancelled search still running on a path worker while it asks
+// for the next one, so searches lock the planner.
+class ChasePlanner {
+public:
+    // Same contract as Pathfinder::findPath: corner cells, start excluded, goal included
+    std::vector<glm::vec3> findPath(glm::vec3 start, glm::vec3 target, const NavigationGrid* grid) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        std::vector<glm::vec3> path;
+        m_LastExpanded = 0;
+        m_LastRepaired = false;
+
+        int startX, startZ, targetX, targetZ;
+        if (!Pathfinder::resolveEndpoints(start, target, grid, startX, startZ, targetX, targetZ)) {
+            m_Route.clear();
+            return path;
+        }
+
+        if (repair((int)start.x, (int)start.z, targetX, targetZ, grid, path)) {
+            m_Repairs++;
+            m_LastRepaired = true;
+        }
+        else {
+            path = Pathfinder::findPath(start, target, grid);
+            m_LastExpanded += Pathfinder::lastStats().nodesExpanded;
+            m_Repairs = 0;
+        }
+
+        m_Route = path;
+        m_RouteX = (int)start.x;
+        m_RouteZ = (int)start.z;
+        m_GoalX = targetX;
+        m_GoalZ = targetZ;
+        m_Grid = grid;
+        return path;
+    }
+
+    // Cells taken off the open list by the last call, and whether it was a repair
+    int getLastExpanded() const { return m_LastExpanded; }
+    bool wasLastRepaired() const { return m_LastRepaired; }
+
+private:
+    static const int MAX_REPAIRS = 8;            // Fresh search after this many repairs in a row
+    static const int REPAIR_RADIUS = 8;          // Target moved further than this: fresh search
+    static const int MAX_REPAIR_EXPANSIONS = 256;
+
+    std::mutex m_Mutex;
+    const NavigationGrid* m_Grid = nullptr;
+
+    // Last route (corner cells) and the cell it started from
+    std::vector<glm::vec3> m_Route;
+    int m_RouteX = 0, m_RouteZ = 0;
+    int m_GoalX = 0, m_GoalZ = 0;
+    int m_Repairs = 0;
+
+    std::vector<int> m_Cells;                    // Scratch: the route as a chain of cells
+    std::vector<std::pair<int, int>> m_OnRoute;  // Scratch: (cell, position in m_Cells), sorted
+    int m_LastExpanded = 0;
+    bool m_LastRepaired = false;
+
+    static int chebyshev(int x0, int z0, int x1, int z1) {
+        return std::max(std::abs(x1 - x0), std::abs(z1 - z0));
+    }
+
+    bool repair(int startX, int startZ, int targetX, int targetZ, const NavigationGrid* grid, std::vector<glm::vec3>& path) {
+        const int size = Pathfinder::MAP_SIZE;
+        if (m_Route.empty() || grid != m_Grid || m_Repairs >= MAX_REPAIRS) return false;
+        if (chebyshev(targetX, targetZ, m_GoalX, m_GoalZ) > REPAIR_RADIUS) return false;
+
+        // 1. The old route as a chain of walkable cells (a cell the map has blocked since breaks the chain)
+        m_Cells.clear();
+        int fromX = m_RouteX, fromZ = m_RouteZ;
+        bool intact = true;
+        auto addCell = [&](int x, int z) {
+            if (!Pathfinder::isWalkable(x, z, grid)) return true; // Origin on a rock, or a skipped corner cell
+            int idx = z * size + x;
+            if (!m_Cells.empty()) {
+                int last = m_Cells.back();
+                if (last == idx) return true;
+                if (chebyshev(x, z, last % size, last / size) > 1) { intact = false; return false; }
+            }
+            m_Cells.push_back(idx);
+            return true;
+        };
+        for (const auto& corner : m_Route) {
+            if (!Pathfinder::walkLine(fromX, fromZ, (int)corner.x, (int)corner.z, addCell)) break;
+            fromX = (int)corner.x;
+            fromZ = (int)corner.z;
+        }
+        if (!intact || m_Cells.empty()) return false;
+
+        // 2. Where we rejoin it: the furthest cell next to us
+        int first = -1;
+        for (int i = (int)m_Cells.size() - 1; i >= 0; i--) {
+            if (chebyshev(startX, startZ, m_Cells[i] % size, m_Cells[i] / size) <= 1) { first = i; break; }
+        }
+        if (first == -1) return false;
+
+        m_OnRoute.clear();
+        for (int i = first; i < (int)m_Cells.size(); i++) m_OnRoute.push_back(std::make_pair(m_Cells[i], i));
+        std::sort(m_OnRoute.begin(), m_OnRoute.end());
+
+        // 3. Search back from the target until we touch the rest of the route
+        SearchArena& arena = SearchArena::local();
+        arena.begin(size, size);
+        int targetIdx = targetZ * size + targetX;
+        arena.pushOrDecrease(targetIdx, 0.0f, 0.0f, -1);
+
+        int meetIdx = -1, meetPos = -1;
+        while (!arena.openEmpty()) {
+            int currentIdx = arena.popMin();
+            arena.close(currentIdx);
+            m_LastExpanded++;
+
+            auto hit = std::lower_bound(m_OnRoute.begin(), m_OnRoute.end(), std::make_pair(currentIdx, -1));
+            if (hit != m_OnRoute.end() && hit->first == currentIdx) {
+                meetIdx = currentIdx;
+                meetPos = hit->second;
+                break;
+            }
+            if (m_LastExpanded > MAX_REPAIR_EXPANSIONS) return false;
+
+            int cx = currentIdx % size;
+            int cz = currentIdx / size;
+            float currentG = arena.g(currentIdx);
+
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    if (dx == 0 && dz == 0) continue;
+
+                    int nx = cx + dx;
+                    int nz = cz + dz;
+                    if (!Pathfinder::isWalkable(nx, nz, grid)) continue;
+
+                    int neighborIdx = nz * size + nx;
+                    if (arena.isClosed(neighborIdx)) continue;
+                    arena.pushOrDecrease(neighborIdx, currentG + ((dx != 0 && dz != 0) ? 1.414f : 1.0f), 0.0f, currentIdx);
+                }
+            }
+        }
+        if (meetIdx == -1) return false;
+
+        // 4. SPLICE: old route up to the meeting cell, then the new piece out to the target
+        path.clear();
+        for (int i = first; i <= meetPos; i++) {
+            if (m_Cells[i] == startZ * size + startX) continue;
+            path.push_back(glm::vec3(m_Cells[i] % size, 0.0f, m_Cells[i] / size));
+        }
+        for (int idx = arena.parent(meetIdx); idx != -1; idx = arena.parent(idx)) {
+            path.push_back(glm::vec3(idx % size, 0.0f, idx / size));
+        }
+        if (path.empty()) path.push_back(glm::vec3(targetX, 0.0f, targetZ));
+
+        Pathfinder::smoothPath(path, startX, startZ, grid);
+        return true;
+    }
+};
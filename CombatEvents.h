@@ -0,0 +1,100 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Unit.h"
+#include "Building.h"
+#include "ParticleManager.h"
+
+// One thing that happened in a fight during a tick
+struct CombatEvent {
+    // ATTACK = a unit swung or fired (recorded by the FSM)
+    // DAMAGE = the attack landed; IMPACT = a mage hit (visuals); DEATH = health reached 0
+    enum class Type { ATTACK, DAMAGE, DEATH, IMPACT };
+
+    Type type = Type::ATTACK;
+    UnitHandle attacker;
+    UnitHandle target;               // Unit hit or killed
+    BuildingHandle building;         // ... or the building hit
+    int amount = 0;                  // Damage
+    bool ranged = false;             // ATTACK: lands with a beam and an IMPACT
+    glm::vec3 from = glm::vec3(0.0f); // Attacker's hand (ranged)
+    glm::vec3 to = glm::vec3(0.0f);   // Hit point, or where the unit died
+};
+
+// The tick's combat, in order: the attacks as the units recorded them (chunk by chunk,
+// so in unit order), followed by what resolve() made of them. Units never touch each
+// other's health during their update; resolve() sums every hit per target, then runs
+// one pass over the health array. The stream stays readable until the next begin(),
+// so anything that wants to see the fight (replays, a network sync) reads it here.
+class CombatLog {
+public:
+    // Start of a tick's resolution: forget the previous tick
+    void begin() {
+        m_Tick++;
+        m_Events.clear();
+    }
+
+    void append(const std::vector<CombatEvent>& attacks) {
+        m_Events.insert(m_Events.end(), attacks.begin(), attacks.end());
+    }
+
+    // Main thread, after the updates: land the recorded attacks
+    void resolve(UnitStore& units) {
+        // 1. DAMAGE: total per store slot (a target hit twice this tick takes both)
+        m_Damage.assign(units.size(), 0);
+        size_t attacks = m_Events.size();
+        for (size_t i = 0; i < attacks; i++) {
+            CombatEvent hit = m_Events[i];
+            if (hit.type != CombatEvent::Type::ATTACK) continue;
+
+            if (Unit* target = Unit::resolve(hit.target)) {
+                m_Damage[target->getSlot()] += hit.amount;
+            }
+            else if (Building* building = Building::resolve(hit.building)) {
+                building->takeDamage((float)hit.amount); // A handful of buildings, no batching needed
+            }
+            else {
+                continue; // Target gone since the attacker looked
+            }
+
+            hit.type = CombatEvent::Type::DAMAGE;
+            m_Events.push_back(hit);
+            if (hit.ranged) {
+                hit.type = CombatEvent::Type::IMPACT;
+                m_Events.push_back(hit);
+            }
+        }
+
+        // 2. HEALTH: one pass over the store
+        for (size_t s = 0; s < units.size(); s++) {
+            if (m_Damage[s] == 0) continue;
+            bool wasAlive = units.health[s] > 0;
+            units.health[s] -= m_Damage[s];
+            if (wasAlive && units.health[s] <= 0) {
+                CombatEvent death;
+                death.type = CombatEvent::Type::DEATH;
+                death.target = units.owner[s]->getHandle();
+                death.to = units.position[s];
+                m_Events.push_back(death);
+            }
+        }
+
+        // 3. IMPACTS: beam and burst for every mage hit
+        for (size_t i = attacks; i < m_Events.size(); i++) {
+            const CombatEvent& e = m_Events[i];
+            if (e.type != CombatEvent::Type::IMPACT) continue;
+            ParticleManager::addMageBeam(e.from, e.to);
+            ParticleManager::addMageImpact(e.to);
+        }
+    }
+
+    const std::vector<CombatEvent>& getEvents() const { return m_Events; }
+    // Ticks resolved so far (the current stream belongs to this one)
+    uint32_t getTick() const { return m_Tick; }
+
+private:
+    std::vector<CombatEvent> m_Events;
+    std::vector<int> m_Damage;       // Scratch: damage per store slot
+    uint32_t m_Tick = 0;
+};
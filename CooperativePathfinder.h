@@ -0,0 +1,324 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "NavigationGrid.h"
+#include "Pathfinder.h"
+#include "FlowField.h"
+#include "SearchArena.h"
+
+// Space-time reservations: which owner holds which cell at which (absolute) step.
+// Open addressing over flat arrays, so a lookup is a multiply and a short probe.
+// release() drops all of an owner's reservations at once by bumping its stamp;
+// the stale entries are skipped by lookups and thrown out when the table would
+// otherwise have to grow.
+class ReservationTable {
+public:
+    // Steps before `now` are history and may be thrown out
+    void setNow(int now) { m_Now = now; }
+
+    void reserve(int cell, int step, int owner) {
+        if (owner >= (int)m_Stamps.size()) m_Stamps.resize(owner + 1, 0);
+        if ((m_Count + 1) * 2 > m_Keys.size()) rebuild();
+
+        uint64_t key = makeKey(cell, step);
+        size_t i = slot(key);
+        while (m_Keys[i] != 0 && m_Keys[i] != key) i = (i + 1) & (m_Keys.size() - 1);
+        if (m_Keys[i] == 0) m_Count++;
+        m_Keys[i] = key;
+        m_Entries[i].owner = owner;
+        m_Entries[i].stamp = m_Stamps[owner];
+    }
+
+    // Owner holding the cell at that step, -1 if it is free
+    int ownerAt(int cell, int step) const {
+        if (m_Keys.empty()) return -1;
+        uint64_t key = makeKey(cell, step);
+        for (size_t i = slot(key); m_Keys[i] != 0; i = (i + 1) & (m_Keys.size() - 1)) {
+            if (m_Keys[i] == key) return isLive(m_Entries[i]) ? m_Entries[i].owner : -1;
+        }
+        return -1;
+    }
+
+    void release(int owner) {
+        if (owner < (int)m_Stamps.size()) m_Stamps[owner]++;
+    }
+
+    size_t size() const { return m_Count; }
+
+private:
+    struct Entry { int owner; uint32_t stamp; };
+
+    std::vector<uint64_t> m_Keys;  // 0 = empty slot; the size is a power of two
+    std::vector<Entry> m_Entries;
+    std::vector<uint32_t> m_Stamps; // Current stamp per owner
+    size_t m_Count = 0;
+    int m_Now = 0;
+
+    // Step + 1 so no key is ever 0
+    static uint64_t makeKey(int cell, int step) { return ((uint64_t)(uint32_t)(step + 1) << 32) | (uint32_t)cell; }
+    static int stepOf(uint64_t key) { return (int)(key >> 32) - 1; }
+
+    size_t slot(uint64_t key) const { return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (m_Keys.size() - 1); }
+    bool isLive(const Entry& e) const { return e.stamp == m_Stamps[e.owner]; }
+
+    // Keep the live, current entries; double the size only if they still fill half of it
+    void rebuild() {
+        std::vector<uint64_t> keys;
+        std::vector<Entry> entries;
+        keys.swap(m_Keys);
+        entries.swap(m_Entries);
+
+        size_t live = 0;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] != 0 && isLive(entries[i]) && stepOf(keys[i]) >= m_Now) live++;
+        }
+        size_t capacity = std::max<size_t>(256, keys.size());
+        while ((live + 1) * 2 > capacity) capacity *= 2;
+
+        m_Keys.assign(capacity, 0ull);
+        m_Entries.assign(capacity, Entry());
+        m_Count = 0;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] == 0 || !isLive(entries[i]) || stepOf(keys[i]) < m_Now) continue;
+            size_t j = slot(keys[i]);
+            while (m_Keys[j] != 0) j = (j + 1) & (m_Keys.size() - 1);
+            m_Keys[j] = keys[i];
+            m_Entries[j] = entries[i];
+            m_Count++;
+        }
+    }
+};
+
+// Windowed cooperative A* (WHCA*) for one group move order.
+// The members share the order's FlowField. Each member plans its next WINDOW steps
+// with a small space-time A* (move to one of the 8 neighbours, or wait) that avoids
+// every cell and swap the other members have reserved, then reserves its own cells.
+// The field's walking distance to the goal region is the estimate past the window,
+// so a search never looks further than WINDOW cells in any direction and its cost
+// does not grow with the length of the trip.
+// A plan is redone once half of it is used up, at most PLANS_PER_STEP members per
+// simulation step (oldest plan first), so a large group spreads its planning over
+// steps. Members report where they are every step. One that stops reporting
+// (arrived, given a new order, dead) is parked: its last cell stays reserved, so
+// the others walk around it instead of through it.
+class CooperativeGroup {
+public:
+    enum {
+        WINDOW = 16,                  // Steps planned ahead
+        MAX_WINDOW_EXPANSIONS = 1024, // Per plan
+        PLANS_PER_STEP = 8
+    };
+    static constexpr float STEP_TIME = 0.15f;   // Seconds per planned step (a cell at about walking speed)
+    static constexpr float PARK_TIMEOUT = 0.5f; // Silence before a member counts as parked
+
+    CooperativeGroup(const NavigationGrid* grid, std::shared_ptr<const FlowField> field)
+        : m_Grid(grid), m_Field(std::move(field)) {}
+
+    // Returns the member index to report with
+    int addMember(const glm::vec3& position, const glm::vec3& slot) {
+        Member m;
+        m.position = position;
+        m.slot = slot;
+        m.lastReport = m_Clock;
+        m_Members.push_back(m);
+        return (int)m_Members.size() - 1;
+    }
+
+    // Member, every simulation step while it follows the group
+    void report(int member, const glm::vec3& position) {
+        Member& m = m_Members[member];
+        m.position = position;
+        m.lastReport = m_Clock;
+    }
+
+    // Centre of the cell the member should be in right now, or its exact slot once
+    // that is the cell. False if it has no plan yet (follow the field instead).
+    bool getStep(int member, glm::vec3& out) const {
+        const Member& m = m_Members[member];
+        if (m.plan.empty()) return false;
+
+        int t = std::min((int)WINDOW, m_Step - m.planStart + 1);
+        int cell = m.plan[t];
+        int x = cell % Pathfinder::MAP_SIZE, z = cell / Pathfinder::MAP_SIZE;
+        if (x == (int)m.slot.x && z == (int)m.slot.z) out = m.slot;
+        else out = glm::vec3(x + 0.5f, 0.0f, z + 0.5f);
+        return true;
+    }
+
+    // Main loop, once per simulation step
+    void update(float dt) {
+        m_Clock += dt;
+        m_Step = (int)(m_Clock / STEP_TIME);
+        m_Table.setNow(m_Step);
+        m_LastPlanned = 0;
+        m_LastExpanded = 0;
+
+        // Oldest plans first (never planned = oldest of all). A failed attempt counts
+        // as a plan, so a boxed-in member does not search again every step.
+        m_Due.clear();
+        for (int i = 0; i < (int)m_Members.size(); i++) {
+            if (planAge(i) >= WINDOW / 2) m_Due.push_back(i);
+        }
+        std::sort(m_Due.begin(), m_Due.end(), [this](int a, int b) {
+            return planAge(a) > planAge(b) || (planAge(a) == planAge(b) && a < b);
+        });
+
+        for (int i : m_Due) {
+            if (m_LastPlanned == PLANS_PER_STEP) break;
+            planMember(i);
+            m_LastPlanned++;
+        }
+    }
+
+    // --- Stats ---
+    int getMemberCount() const { return (int)m_Members.size(); }
+    int getLastPlanned() const { return m_LastPlanned; }
+    int getLastExpanded() const { return m_LastExpanded; }
+    size_t getReservationCount() const { return m_Table.size(); }
+
+private:
+    struct Member {
+        glm::vec3 position;
+        glm::vec3 slot;
+        float lastReport = 0.0f;
+        bool parked = false;
+        int planStart = -1;           // Step of the last plan (or attempt), -1 = never planned
+        std::vector<int> plan;        // Cell for steps planStart..planStart + WINDOW, empty = no plan
+    };
+
+    // Search nodes: a (2 * WINDOW + 1)^2 box of cells around the member, one layer per step
+    enum { SIDE = 2 * WINDOW + 1, LAYER = SIDE * SIDE };
+
+    const NavigationGrid* m_Grid;
+    std::shared_ptr<const FlowField> m_Field;
+    std::vector<Member> m_Members;
+    ReservationTable m_Table;
+    SearchArena m_Arena;
+    std::vector<int> m_Due;           // Scratch: members to plan this frame
+
+    float m_Clock = 0.0f;
+    int m_Step = 0;
+    int m_LastPlanned = 0;
+    int m_LastExpanded = 0;
+
+    static int cellOf(const glm::vec3& pos) { return (int)pos.z * Pathfinder::MAP_SIZE + (int)pos.x; }
+
+    int planAge(int member) const {
+        const Member& m = m_Members[member];
+        return (m.planStart < 0) ? 1 << 30 : m_Step - m.planStart;
+    }
+
+    // Lower bound on the walk from a cell to the member's slot
+    float estimate(int x, int z, const glm::vec3& slot) const {
+        glm::vec3 centre(x + 0.5f, 0.0f, z + 0.5f);
+        return std::max(m_Field->getCost(centre), glm::distance(centre, glm::vec3(slot.x, 0.0f, slot.z)) - 1.0f);
+    }
+
+    bool isWalkable(int x, int z) const { return Pathfinder::isWalkable(x, z, m_Grid); }
+
+    // Free for us at that step
+    bool isFree(int cell, int step, int member) const {
+        int owner = m_Table.ownerAt(cell, step);
+        return owner == -1 || owner == member;
+    }
+
+    // The slot is ours from step t to the end of the window
+    bool canStay(int cell, int t, int member) const {
+        for (; t <= WINDOW; t++) {
+            if (!isFree(cell, m_Step + t, member)) return false;
+        }
+        return true;
+    }
+
+    void planMember(int member) {
+        Member& m = m_Members[member];
+        m_Table.release(member);
+        m.plan.clear();
+        m.planStart = m_Step;
+
+        const int size = Pathfinder::MAP_SIZE;
+        int startX = (int)m.position.x, startZ = (int)m.position.z;
+        int startCell = startZ * size + startX;
+
+        // Parked, or pushed onto a rock: just hold the cell
+        if (m_Clock - m.lastReport > PARK_TIMEOUT) m.parked = true;
+        if (m.parked || !isWalkable(startX, startZ)) {
+            if (m.parked) m.plan.assign(WINDOW + 1, startCell);
+            for (int t = 0; t <= WINDOW; t++) m_Table.reserve(startCell, m_Step + t, member);
+            return;
+        }
+
+        int goalX = (int)m.slot.x, goalZ = (int)m.slot.z;
+        int x0 = startX - WINDOW, z0 = startZ - WINDOW;
+        m_Arena.begin(LAYER, WINDOW + 1);
+        m_Arena.pushOrDecrease(WINDOW * SIDE + WINDOW, 0.0f, estimate(startX, startZ, m.slot), -1);
+
+        int finalIdx = -1, expanded = 0;
+        while (!m_Arena.openEmpty() && expanded < MAX_WINDOW_EXPANSIONS) {
+            int currentIdx = m_Arena.popMin();
+            m_Arena.close(currentIdx);
+            expanded++;
+
+            int t = currentIdx / LAYER;
+            int cx = x0 + currentIdx % SIDE;
+            int cz = z0 + (currentIdx % LAYER) / SIDE;
+            int cell = cz * size + cx;
+            bool atGoal = (cx == goalX && cz == goalZ);
+
+            // End of the window, or our slot and nobody needs it later on
+            if (t == WINDOW || (atGoal && canStay(cell, t, member))) {
+                finalIdx = currentIdx;
+                break;
+            }
+
+            float currentG = m_Arena.g(currentIdx);
+            int step = m_Step + t;
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    int nx = cx + dx, nz = cz + dz;
+                    bool wait = (dx == 0 && dz == 0);
+                    if (!wait) {
+                        if (!isWalkable(nx, nz)) continue;
+                        // Like the flow field: no squeezing diagonally past a corner
+                        if (dx != 0 && dz != 0 && (!isWalkable(nx, cz) || !isWalkable(cx, nz))) continue;
+                    }
+
+                    // Someone else is there at the next step, or is swapping cells with us
+                    int nextCell = nz * size + nx;
+                    if (!isFree(nextCell, step + 1, member)) continue;
+                    if (!wait) {
+                        int coming = m_Table.ownerAt(nextCell, step);
+                        if (coming != -1 && coming != member && m_Table.ownerAt(cell, step + 1) == coming) continue;
+                    }
+
+                    int neighborIdx = (t + 1) * LAYER + (nz - z0) * SIDE + (nx - x0);
+                    if (m_Arena.isClosed(neighborIdx)) continue;
+                    float stepCost = wait ? (atGoal ? 0.0f : 1.0f) : ((dx != 0 && dz != 0) ? 1.414f : 1.0f);
+                    m_Arena.pushOrDecrease(neighborIdx, currentG + stepCost, estimate(nx, nz, m.slot), currentIdx);
+                }
+            }
+        }
+        m_LastExpanded += expanded;
+
+        if (finalIdx == -1) {
+            // Boxed in (or out of budget): no plan, just keep others off our cell for now
+            m_Table.reserve(startCell, m_Step, member);
+            m_Table.reserve(startCell, m_Step + 1, member);
+            return;
+        }
+
+        // Cells by step, then wait on the slot for the rest of the window
+        m.plan.assign(WINDOW + 1, -1);
+        for (int idx = finalIdx; idx != -1; idx = m_Arena.parent(idx)) {
+            m.plan[idx / LAYER] = (z0 + (idx % LAYER) / SIDE) * size + (x0 + idx % SIDE);
+        }
+        for (int t = 1; t <= WINDOW; t++) {
+            if (m.plan[t] == -1) m.plan[t] = m.plan[t - 1];
+        }
+        for (int t = 0; t <= WINDOW; t++) m_Table.reserve(m.plan[t], m_Step + t, member);
+    }
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+
+// Queue of at most N items stored inside the object (a ring buffer), for the
+// short per-unit task and target lists. Unlike std::deque it never touches the
+// heap, so units can be created, ordered around and destroyed without a single
+// allocation. A full queue refuses new items (push_back returns false); callers
+// that may overflow decide beforehand which items are worth keeping.
+template <class T, size_t N>
+class FixedQueue {
+public:
+    enum : size_t { CAPACITY = N };
+
+    bool empty() const { return m_Size == 0; }
+    bool full() const { return m_Size == N; }
+    size_t size() const { return m_Size; }
+
+    bool push_back(const T& item) {
+        if (full()) return false;
+        m_Items[(m_Head + m_Size) % N] = item;
+        m_Size++;
+        return true;
+    }
+
+    void pop_front() {
+        if (empty()) return;
+        m_Head = (m_Head + 1) % N;
+        m_Size--;
+    }
+
+    T& front() { return m_Items[m_Head]; }
+    const T& front() const { return m_Items[m_Head]; }
+
+    // i-th item from the front
+    T& operator[](size_t i) { return m_Items[(m_Head + i) % N]; }
+    const T& operator[](size_t i) const { return m_Items[(m_Head + i) % N]; }
+
+    // Remove the i-th item, keeping the order of the rest
+    void erase(size_t i) {
+        for (; i + 1 < m_Size; i++) (*this)[i] = (*this)[i + 1];
+        m_Size--;
+    }
+
+    // Keep only the first n items
+    void truncate(size_t n) {
+        if (n < m_Size) m_Size = n;
+    }
+
+    void clear() {
+        m_Head = 0;
+        m_Size = 0;
+    }
+
+private:
+    T m_Items[N];
+    size_t m_Head = 0;
+    size_t m_Size = 0;
+};
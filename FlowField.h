@@ -0,0 +1,258 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "NavigationGrid.h"
+#include "Pathfinder.h"
+#include "SearchArena.h"
+
+// Flow field for group move orders.
+// One Dijkstra pass spreads outwards from every walkable cell of the goal region and
+// records, per cell, which neighbour is one step closer to the goal. Every unit of the
+// order then just looks up the cell it stands on, so moving N units costs one search
+// instead of N.
+// The search stops once every unit's start cell is settled (plus a small margin for
+// units that get pushed around), so it rarely covers the whole map.
+// The field is a snapshot: it remembers the grid version it was built on and the
+// box it covers, so its units can tell when something was built across their way.
+class FlowField {
+public:
+    // Direction codes 0-7 index the 8 neighbour offsets, these two are special
+    enum : uint8_t {
+        NO_DIRECTION = 255, // Not reached by the search
+        AT_GOAL = 254       // Inside the goal region
+    };
+
+    explicit FlowField(const NavigationGrid* grid)
+        : m_Grid(grid), m_Width(grid->getWidth()), m_Height(grid->getHeight()) {}
+
+    // Build the field towards the walkable cells within goalRadius of goal.
+    // Returns false if no walkable goal cell exists.
+    bool build(const glm::vec3& goal, float goalRadius, const std::vector<glm::vec3>& starts) {
+        size_t cells = (size_t)m_Width * (size_t)m_Height;
+        m_Dir.assign(cells, NO_DIRECTION);
+        m_Cost.assign(cells, -1.0f);
+        m_SettledCells = 0;
+        m_Version = m_Grid->getVersion();
+        m_MinX = m_Width;
+        m_MinZ = m_Height;
+        m_MaxX = -1;
+        m_MaxZ = -1;
+
+        int goalX = std::max(Pathfinder::BORDER_SIZE, std::min((int)goal.x, m_Width - Pathfinder::BORDER_SIZE - 1));
+        int goalZ = std::max(Pathfinder::BORDER_SIZE, std::min((int)goal.z, m_Height - Pathfinder::BORDER_SIZE - 1));
+
+        // Clicked on a rock: move the goal region next to it
+        if (!isWalkable(goalX, goalZ)) {
+            glm::vec3 freeGoal = Pathfinder::findNearestWalkable(goalX, goalZ, m_Grid);
+            if (freeGoal.x == -1.0f) return false;
+            goalX = (int)freeGoal.x;
+            goalZ = (int)freeGoal.z;
+        }
+
+        // Walled off from every unit: move the goal to the closest cell the first of them can reach
+        int goalRegion = m_Grid->getRegion(goalX, goalZ);
+        int firstRegion = 0;
+        bool connected = false;
+        for (const auto& s : starts) {
+            int region = m_Grid->getRegion((int)s.x, (int)s.z);
+            if (region == 0) continue;
+            if (firstRegion == 0) firstRegion = region;
+            if (region == goalRegion) { connected = true; break; }
+        }
+        if (!connected && firstRegion != 0 && goalRegion != 0) {
+            glm::vec3 reachable = Pathfinder::findNearestInRegion(goalX, goalZ, firstRegion, m_Grid);
+            if (reachable.x != -1.0f) {
+                goalX = (int)reachable.x;
+                goalZ = (int)reachable.z;
+            }
+        }
+        m_GoalX = goalX;
+        m_GoalZ = goalZ;
+
+        SearchArena& arena = SearchArena::local();
+        arena.begin(m_Width, m_Height);
+
+        // 1. SEED: every walkable cell of the goal region starts at cost 0
+        int r = (int)std::ceil(goalRadius);
+        for (int x = goalX - r; x <= goalX + r; x++) {
+            for (int z = goalZ - r; z <= goalZ + r; z++) {
+                float dx = (float)(x - goalX), dz = (float)(z - goalZ);
+                if (dx * dx + dz * dz > goalRadius * goalRadius) continue;
+                if (!isWalkable(x, z)) continue;
+                arena.pushOrDecrease(z * m_Width + x, 0.0f, 0.0f, -1);
+            }
+        }
+        arena.pushOrDecrease(goalZ * m_Width + goalX, 0.0f, 0.0f, -1);
+
+        // 2. Which cells we have to reach before we may stop
+        std::vector<int> pending;
+        for (const auto& s : starts) {
+            int sx = (int)s.x, sz = (int)s.z;
+            if (sx < 0 || sx >= m_Width || sz < 0 || sz >= m_Height) continue;
+            pending.push_back(sz * m_Width + sx);
+        }
+        std::sort(pending.begin(), pending.end());
+        pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+        size_t remaining = pending.size();
+        float stopCost = -1.0f;
+
+        // 3. DIJKSTRA outwards from the goal
+        while (!arena.openEmpty()) {
+            int current = arena.popMin();
+            arena.close(current);
+
+            float g = arena.g(current);
+            if (stopCost >= 0.0f && g > stopCost) break;
+
+            int cx = current % m_Width;
+            int cz = current / m_Width;
+
+            int parent = arena.parent(current);
+            m_Dir[current] = (parent == -1) ? (uint8_t)AT_GOAL : directionCode(parent % m_Width - cx, parent / m_Width - cz);
+            m_Cost[current] = g;
+            m_SettledCells++;
+            m_MinX = std::min(m_MinX, cx);
+            m_MinZ = std::min(m_MinZ, cz);
+            m_MaxX = std::max(m_MaxX, cx);
+            m_MaxZ = std::max(m_MaxZ, cz);
+
+            if (remaining > 0 && std::binary_search(pending.begin(), pending.end(), current)) {
+                if (--remaining == 0) stopCost = g + MARGIN;
+            }
+
+            for (int i = 0; i < 8; i++) {
+                int nx = cx + stepX(i);
+                int nz = cz + stepZ(i);
+                if (!isWalkable(nx, nz)) continue;
+
+                // Unlike the A* grid, no squeezing diagonally past a corner:
+                // units steer straight at the next cell and would clip it
+                if ((i & 1) && (!isWalkable(nx, cz) || !isWalkable(cx, nz))) continue;
+
+                int neighborIdx = nz * m_Width + nx;
+                if (arena.isClosed(neighborIdx)) continue;
+                arena.pushOrDecrease(neighborIdx, g + ((i & 1) ? 1.414f : 1.0f), 0.0f, current);
+            }
+        }
+
+        // Start cells that sit on blocked tiles (pushed into a wall) borrow a neighbour's direction
+        for (int idx : pending) {
+            if (m_Dir[idx] == NO_DIRECTION) patchBlockedCell(idx % m_Width, idx / m_Width);
+        }
+
+        return true;
+    }
+
+    // Where the goal region was placed (after moving it off blocked tiles)
+    glm::vec3 getGoal() const { return glm::vec3((float)m_GoalX, 0.0f, (float)m_GoalZ); }
+
+    bool isInGoal(const glm::vec3& pos) const { return code(pos) == AT_GOAL; }
+    bool isReachable(const glm::vec3& pos) const { return code(pos) != NO_DIRECTION; }
+
+    // Unit direction (y = 0) from pos towards the centre of the next cell. Zero at the goal or off the field.
+    glm::vec3 getDirection(const glm::vec3& pos) const {
+        uint8_t c = code(pos);
+        if (c >= 8) return glm::vec3(0.0f);
+
+        glm::vec3 next((int)pos.x + stepX(c) + 0.5f, 0.0f, (int)pos.z + stepZ(c) + 0.5f);
+        glm::vec3 dir = next - glm::vec3(pos.x, 0.0f, pos.z);
+        float len = glm::length(dir);
+        return (len > 0.001f) ? dir / len : glm::vec3(0.0f);
+    }
+
+    // Walking distance to the goal region, -1 if not reached
+    float getCost(const glm::vec3& pos) const {
+        int idx = index(pos);
+        return (idx == -1) ? -1.0f : m_Cost[idx];
+    }
+
+    int getSettledCells() const { return m_SettledCells; }
+
+    // Grid version the field was built on
+    uint64_t getVersion() const { return m_Version; }
+
+    // True if the grid changed inside the area the field covers after `version`
+    bool isChangedSince(uint64_t version) const {
+        if (m_MaxX < 0) return false;
+        return m_Grid->isAreaChangedSince(version, m_MinX, m_MinZ, m_MaxX, m_MaxZ);
+    }
+
+    // Follow the field from pos to the goal region, asking isClear(x, z) about every
+    // cell we still have to enter. False as soon as one is not clear.
+    template <class ClearFn>
+    bool walkRoute(const glm::vec3& pos, ClearFn isClear) const {
+        int x = (int)pos.x, z = (int)pos.z;
+        for (int steps = 0; steps <= m_SettledCells; steps++) { // A field has no loops, but a cap costs nothing
+            uint8_t c = code(glm::vec3((float)x, 0.0f, (float)z));
+            if (c >= 8) break; // At the goal (or off the field)
+            x += stepX(c);
+            z += stepZ(c);
+            if (!isClear(x, z)) return false;
+        }
+        return true;
+    }
+
+private:
+    // Cost past the farthest unit we keep expanding, so units shoved off course still find their way
+    static constexpr float MARGIN = 24.0f;
+
+    // Straight moves on even codes, diagonals on odd ones (counter-clockwise from +x)
+    static int stepX(int code) {
+        static const int dx[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+        return dx[code];
+    }
+    static int stepZ(int code) {
+        static const int dz[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+        return dz[code];
+    }
+
+    const NavigationGrid* m_Grid;
+    int m_Width, m_Height;
+    int m_GoalX = 0, m_GoalZ = 0;
+    int m_SettledCells = 0;
+    uint64_t m_Version = 0;
+    int m_MinX = 0, m_MinZ = 0, m_MaxX = -1, m_MaxZ = -1; // Box of the settled cells
+
+    std::vector<uint8_t> m_Dir;  // Direction code per cell
+    std::vector<float> m_Cost;   // Walking distance to the goal region, -1 if not reached
+
+    bool isWalkable(int x, int z) const {
+        if (x < 0 || x >= m_Width || z < 0 || z >= m_Height) return false;
+        return Pathfinder::isWalkable(x, z, m_Grid);
+    }
+
+    int index(const glm::vec3& pos) const {
+        int x = (int)pos.x, z = (int)pos.z;
+        if (x < 0 || x >= m_Width || z < 0 || z >= m_Height || m_Dir.empty()) return -1;
+        return z * m_Width + x;
+    }
+
+    uint8_t code(const glm::vec3& pos) const {
+        int idx = index(pos);
+        return (idx == -1) ? (uint8_t)NO_DIRECTION : m_Dir[idx];
+    }
+
+    static uint8_t directionCode(int dx, int dz) {
+        for (uint8_t i = 0; i < 8; i++) {
+            if (stepX(i) == dx && stepZ(i) == dz) return i;
+        }
+        return NO_DIRECTION;
+    }
+
+    // Point a blocked cell at its cheapest reached neighbour
+    void patchBlockedCell(int x, int z) {
+        float best = -1.0f;
+        for (uint8_t i = 0; i < 8; i++) {
+            int nx = x + stepX(i), nz = z + stepZ(i);
+            if (nx < 0 || nx >= m_Width || nz < 0 || nz >= m_Height) continue;
+            float c = m_Cost[nz * m_Width + nx];
+            if (c < 0.0f || (best >= 0.0f && c >= best)) continue;
+            best = c;
+            m_Dir[z * m_Width + x] = i;
+            m_Cost[z * m_Width + x] = c + 1.0f;
+        }
+    }
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Reference to an object in a HandleTable: a slot plus the generation that slot
+// had when the object was added. Cheap to copy and store, and unlike a raw pointer
+// or a plain ID it can always be checked: once the object is gone the slot's
+// generation moves on and the handle resolves to nullptr.
+template <class T>
+struct Handle {
+    enum : uint32_t { NONE = 0xFFFFFFFFu };
+
+    uint32_t index = NONE;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == NONE; }
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+// Slot map from handles to live objects. add/remove/get are all O(1): freed slots
+// are reused through a free list, and each reuse bumps the slot's generation so
+// handles to the previous occupant go stale instead of pointing at the new one.
+// The table does not own the objects; they add themselves on construction and
+// remove themselves on destruction (see Unit and Building).
+template <class T>
+class HandleTable {
+public:
+    Handle<T> add(T* object) {
+        uint32_t index;
+        if (!m_Free.empty()) {
+            index = m_Free.back();
+            m_Free.pop_back();
+        }
+        else {
+            index = (uint32_t)m_Slots.size();
+            m_Slots.push_back(Slot());
+        }
+        m_Slots[index].object = object;
+        m_Count++;
+
+        Handle<T> h;
+        h.index = index;
+        h.generation = m_Slots[index].generation;
+        return h;
+    }
+
+    void remove(Handle<T> h) {
+        if (!get(h)) return;
+        Slot& slot = m_Slots[h.index];
+        slot.object = nullptr;
+        slot.generation++;
+        m_Free.push_back(h.index);
+        m_Count--;
+    }
+
+    // The object, or nullptr if the handle is null or its object is gone
+    T* get(Handle<T> h) const {
+        if (h.index >= m_Slots.size()) return nullptr;
+        const Slot& slot = m_Slots[h.index];
+        return (slot.generation == h.generation) ? slot.object : nullptr;
+    }
+
+    size_t size() const { return m_Count; }
+
+private:
+    struct Slot {
+        T* object = nullptr;
+        uint32_t generation = 0;
+    };
+
+    std::vector<Slot> m_Slots;
+    std::vector<uint32_t> m_Free;
+    size_t m_Count = 0;
+};
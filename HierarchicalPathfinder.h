@@ -0,0 +1,451 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "NavigationGrid.h"
+#include "SearchArena.h"
+
+// HPA* (Hierarchical Path-Finding A*) over a NavigationGrid.
+// The map is cut into square clusters. Where two clusters share a walkable stretch
+// of border we place an entrance: a pair of abstract nodes, one on each side.
+// Nodes of the same cluster are linked with their cached in-cluster distance.
+// A query searches this small graph first, then refines each hop with a tiny
+// A* confined to one cluster.
+//
+// Grid changes only mark the clusters they touch as dirty. Before the next query
+// those clusters get their borders re-scanned, and they plus their direct
+// neighbours (which share the re-scanned borders) get their distances recomputed.
+class HierarchicalPathfinder {
+public:
+    HierarchicalPathfinder(NavigationGrid* grid, int borderSize, int clusterSize = 16)
+        : m_Grid(grid), m_BorderSize(borderSize), m_ClusterSize(clusterSize)
+    {
+        m_Width = grid->getWidth();
+        m_Height = grid->getHeight();
+        m_ClustersX = (m_Width + m_ClusterSize - 1) / m_ClusterSize;
+        m_ClustersZ = (m_Height + m_ClusterSize - 1) / m_ClusterSize;
+
+        int clusterCount = m_ClustersX * m_ClustersZ;
+        m_ClusterNodes.resize(clusterCount);
+        m_ClusterDirty.assign(clusterCount, true);
+        m_RightBorders.resize(clusterCount);
+        m_BottomBorders.resize(clusterCount);
+        m_AnyDirty = true;
+
+        m_ListenerID = m_Grid->addChangeListener([this](int minX, int minZ, int maxX, int maxZ) {
+            markDirty(minX, minZ, maxX, maxZ);
+        });
+
+        refresh();
+    }
+
+    ~HierarchicalPathfinder() {
+        m_Grid->removeChangeListener(m_ListenerID);
+    }
+
+    const NavigationGrid* getGrid() const { return m_Grid; }
+    int getClusterCount() const { return m_ClustersX * m_ClustersZ; }
+    int getLastRebuiltClusters() const { return m_LastRebuiltClusters; }
+
+    // Mark every cluster overlapping the (inclusive) cell rectangle for rebuild
+    void markDirty(int minX, int minZ, int maxX, int maxZ) {
+        if (maxX < 0 || maxZ < 0) return;
+        int cx0 = std::max(0, minX / m_ClusterSize);
+        int cz0 = std::max(0, minZ / m_ClusterSize);
+        int cx1 = std::min(m_ClustersX - 1, maxX / m_ClusterSize);
+        int cz1 = std::min(m_ClustersZ - 1, maxZ / m_ClusterSize);
+
+        for (int cz = cz0; cz <= cz1; cz++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                m_ClusterDirty[cz * m_ClustersX + cx] = true;
+                m_AnyDirty = true;
+            }
+        }
+    }
+
+    // Rebuild dirty clusters (called lazily before every query)
+    void refresh() {
+        m_LastRebuiltClusters = 0;
+        if (!m_AnyDirty) return;
+        m_AnyDirty = false;
+
+        int clusterCount = m_ClustersX * m_ClustersZ;
+        std::vector<bool> recompute(clusterCount, false);
+
+        for (int c = 0; c < clusterCount; c++) {
+            if (!m_ClusterDirty[c]) continue;
+            m_ClusterDirty[c] = false;
+            m_LastRebuiltClusters++;
+
+            int cx = c % m_ClustersX;
+            int cz = c / m_ClustersX;
+
+            // The four borders of this cluster
+            if (cx + 1 < m_ClustersX) rebuildBorder(c, c + 1, true);
+            if (cx > 0) rebuildBorder(c - 1, c, true);
+            if (cz + 1 < m_ClustersZ) rebuildBorder(c, c + m_ClustersX, false);
+            if (cz > 0) rebuildBorder(c - m_ClustersX, c, false);
+
+            recompute[c] = true;
+            if (cx + 1 < m_ClustersX) recompute[c + 1] = true;
+            if (cx > 0) recompute[c - 1] = true;
+            if (cz + 1 < m_ClustersZ) recompute[c + m_ClustersX] = true;
+            if (cz > 0) recompute[c - m_ClustersX] = true;
+        }
+
+        for (int c = 0; c < clusterCount; c++) {
+            if (recompute[c]) rebuildIntraEdges(c);
+        }
+    }
+
+    // Returns per-cell waypoints (start excluded, goal included), empty if unreachable
+    std::vector<glm::vec3> findPath(int startX, int startZ, int targetX, int targetZ, int& nodesExpanded) {
+        std::vector<glm::vec3> path;
+        nodesExpanded = 0;
+        refresh();
+
+        int startCluster = clusterOf(startX, startZ);
+        int goalCluster = clusterOf(targetX, targetZ);
+
+        // Same cluster: a local search is usually enough
+        if (startCluster == goalCluster) {
+            if (searchInCluster(startX, startZ, targetX, targetZ, startCluster, path, nodesExpanded)) return path;
+            path.clear();
+        }
+
+        // Temporary links from start/goal into their clusters' entrances
+        int nodeCount = (int)m_Nodes.size();
+        int startID = nodeCount;
+        int goalID = nodeCount + 1;
+
+        std::vector<AbstractEdge> startLinks;
+        clusterDistances(startX, startZ, startCluster, startLinks);
+
+        std::vector<AbstractEdge> goalLinks;
+        clusterDistances(targetX, targetZ, goalCluster, goalLinks);
+        m_GoalLinkCost.assign(nodeCount, -1.0f);
+        for (const auto& e : goalLinks) m_GoalLinkCost[e.to] = e.cost;
+
+        // Abstract A*
+        int capacity = ((goalID + 1 + 1023) / 1024) * 1024;
+        m_AbstractArena.begin(capacity, 1);
+        m_AbstractArena.pushOrDecrease(startID, 0.0f, distance(startX, startZ, targetX, targetZ), -1);
+
+        bool found = false;
+        while (!m_AbstractArena.openEmpty()) {
+            int current = m_AbstractArena.popMin();
+            m_AbstractArena.close(current);
+            nodesExpanded++;
+
+            if (current == goalID) { found = true; break; }
+
+            float g = m_AbstractArena.g(current);
+
+            if (current == startID) {
+                for (const auto& e : startLinks) relax(e.to, g + e.cost, current, targetX, targetZ);
+                continue;
+            }
+
+            const AbstractNode& node = m_Nodes[current];
+            relax(node.partner, g + 1.0f, current, targetX, targetZ);
+            for (const auto& e : node.edges) relax(e.to, g + e.cost, current, targetX, targetZ);
+
+            if (m_GoalLinkCost[current] >= 0.0f) {
+                if (!m_AbstractArena.isClosed(goalID)) {
+                    m_AbstractArena.pushOrDecrease(goalID, g + m_GoalLinkCost[current], 0.0f, current);
+                }
+            }
+        }
+        if (!found) return path;
+
+        // Collect abstract waypoints (goal -> start)
+        std::vector<int> hops;
+        for (int id = m_AbstractArena.parent(goalID); id != startID && id != -1; id = m_AbstractArena.parent(id)) {
+            hops.push_back(id);
+        }
+        std::reverse(hops.begin(), hops.end());
+
+        // Refine: in-cluster hops get a local A*, border crossings are single steps
+        int curX = startX, curZ = startZ;
+        hops.push_back(-1); // Goal marker
+        for (int hop : hops) {
+            int nextX = (hop == -1) ? targetX : m_Nodes[hop].x;
+            int nextZ = (hop == -1) ? targetZ : m_Nodes[hop].z;
+            if (nextX == curX && nextZ == curZ) continue;
+
+            int curCluster = clusterOf(curX, curZ);
+            if (curCluster == clusterOf(nextX, nextZ)) {
+                if (!searchInCluster(curX, curZ, nextX, nextZ, curCluster, path, nodesExpanded)) {
+                    path.clear();
+                    return path;
+                }
+            }
+            else {
+                path.push_back(glm::vec3(nextX, 0.0f, nextZ));
+            }
+            curX = nextX;
+            curZ = nextZ;
+        }
+        return path;
+    }
+
+private:
+    struct AbstractEdge {
+        int to;
+        float cost;
+    };
+
+    struct AbstractNode {
+        int x, z;
+        int cluster;
+        int partner;                     // Node on the other side of the border (cost 1)
+        std::vector<AbstractEdge> edges; // Cached distances to the other entrances of the cluster
+    };
+
+    NavigationGrid* m_Grid;
+    int m_ListenerID = -1;
+    int m_BorderSize;
+    int m_ClusterSize;
+    int m_Width, m_Height;
+    int m_ClustersX, m_ClustersZ;
+
+    std::vector<AbstractNode> m_Nodes;
+    std::vector<int> m_FreeNodes;                 // Recycled node ids
+    std::vector<std::vector<int>> m_ClusterNodes; // Entrance nodes per cluster
+    std::vector<std::vector<int>> m_RightBorders;  // Nodes on the border with the cluster to the right (+x)
+    std::vector<std::vector<int>> m_BottomBorders; // Nodes on the border with the cluster below (+z)
+    std::vector<bool> m_ClusterDirty;
+    bool m_AnyDirty = false;
+    int m_LastRebuiltClusters = 0;
+
+    SearchArena m_AbstractArena;
+    SearchArena m_ClusterArena;      // Entrance-to-entrance distances, indexed in cluster space
+    std::vector<float> m_GoalLinkCost;
+
+    bool isWalkable(int x, int z) const {
+        if (x < m_BorderSize || x >= m_Width - m_BorderSize ||
+            z < m_BorderSize || z >= m_Height - m_BorderSize) return false;
+        return !m_Grid->isBlockedUnchecked(x, z); // Inside the map after the border test
+    }
+
+    int clusterOf(int x, int z) const {
+        return (z / m_ClusterSize) * m_ClustersX + (x / m_ClusterSize);
+    }
+
+    void clusterBounds(int cluster, int& minX, int& minZ, int& maxX, int& maxZ) const {
+        int cx = cluster % m_ClustersX;
+        int cz = cluster / m_ClustersX;
+        minX = cx * m_ClusterSize;
+        minZ = cz * m_ClusterSize;
+        maxX = std::min(minX + m_ClusterSize, m_Width) - 1;
+        maxZ = std::min(minZ + m_ClusterSize, m_Height) - 1;
+    }
+
+    static float distance(int x, int z, int tx, int tz) {
+        float dx = (float)(x - tx);
+        float dz = (float)(z - tz);
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    void relax(int to, float g, int from, int targetX, int targetZ) {
+        if (m_AbstractArena.isClosed(to)) return;
+        m_AbstractArena.pushOrDecrease(to, g, distance(m_Nodes[to].x, m_Nodes[to].z, targetX, targetZ), from);
+    }
+
+    int allocNode(int x, int z, int cluster) {
+        int id;
+        if (!m_FreeNodes.empty()) {
+            id = m_FreeNodes.back();
+            m_FreeNodes.pop_back();
+        }
+        else {
+            id = (int)m_Nodes.size();
+            m_Nodes.push_back(AbstractNode());
+        }
+        AbstractNode& n = m_Nodes[id];
+        n.x = x;
+        n.z = z;
+        n.cluster = cluster;
+        n.partner = -1;
+        n.edges.clear();
+        m_ClusterNodes[cluster].push_back(id);
+        return id;
+    }
+
+    void freeNode(int id) {
+        std::vector<int>& list = m_ClusterNodes[m_Nodes[id].cluster];
+        list.erase(std::remove(list.begin(), list.end(), id), list.end());
+        m_Nodes[id].edges.clear();
+        m_Nodes[id].cluster = -1;
+        m_Nodes[id].partner = -1;
+        m_FreeNodes.push_back(id);
+    }
+
+    // Re-scan the shared border of clusters a (left/top) and b (right/bottom)
+    void rebuildBorder(int a, int b, bool horizontal) {
+        std::vector<int>& border = horizontal ? m_RightBorders[a] : m_BottomBorders[a];
+        for (int id : border) freeNode(id);
+        border.clear();
+
+        int minX, minZ, maxX, maxZ;
+        clusterBounds(a, minX, minZ, maxX, maxZ);
+
+        // Cells along the border: side A is the last row/column of a, side B the first of b
+        int length = horizontal ? (maxZ - minZ + 1) : (maxX - minX + 1);
+        int runStart = -1;
+        for (int i = 0; i <= length; i++) {
+            bool open = false;
+            if (i < length) {
+                int ax = horizontal ? maxX : minX + i;
+                int az = horizontal ? minZ + i : maxZ;
+                int bx = horizontal ? maxX + 1 : ax;
+                int bz = horizontal ? az : maxZ + 1;
+                open = isWalkable(ax, az) && isWalkable(bx, bz);
+            }
+
+            if (open && runStart == -1) runStart = i;
+            if (!open && runStart != -1) {
+                int runEnd = i - 1;
+                // Short openings get one entrance in the middle, long ones one at each end
+                if (runEnd - runStart + 1 < 6) {
+                    addTransition(a, b, horizontal, (runStart + runEnd) / 2, border);
+                }
+                else {
+                    addTransition(a, b, horizontal, runStart, border);
+                    addTransition(a, b, horizontal, runEnd, border);
+                }
+                runStart = -1;
+            }
+        }
+    }
+
+    void addTransition(int a, int b, bool horizontal, int offset, std::vector<int>& border) {
+        int minX, minZ, maxX, maxZ;
+        clusterBounds(a, minX, minZ, maxX, maxZ);
+        int ax = horizontal ? maxX : minX + offset;
+        int az = horizontal ? minZ + offset : maxZ;
+        int bx = horizontal ? maxX + 1 : ax;
+        int bz = horizontal ? az : maxZ + 1;
+
+        int na = allocNode(ax, az, a);
+        int nb = allocNode(bx, bz, b);
+        m_Nodes[na].partner = nb;
+        m_Nodes[nb].partner = na;
+        border.push_back(na);
+        border.push_back(nb);
+    }
+
+    // Recompute the cached distances between the entrances of one cluster
+    void rebuildIntraEdges(int cluster) {
+        const std::vector<int>& nodes = m_ClusterNodes[cluster];
+        for (int id : nodes) m_Nodes[id].edges.clear();
+
+        // Distances are symmetric: one search per node covers the pairs after it
+        std::vector<AbstractEdge> reached;
+        for (size_t i = 0; i + 1 < nodes.size(); i++) {
+            int id = nodes[i];
+            clusterDistances(m_Nodes[id].x, m_Nodes[id].z, cluster, reached);
+            for (const auto& e : reached) {
+                if (e.to == id) continue;
+                if (std::find(nodes.begin(), nodes.begin() + i, e.to) != nodes.begin() + i) continue;
+                m_Nodes[id].edges.push_back(e);
+                m_Nodes[e.to].edges.push_back({ id, e.cost });
+            }
+        }
+    }
+
+    // Dijkstra confined to one cluster: cost from (x,z) to each reachable entrance of it
+    void clusterDistances(int x, int z, int cluster, std::vector<AbstractEdge>& out) {
+        out.clear();
+        const std::vector<int>& nodes = m_ClusterNodes[cluster];
+        if (nodes.empty()) return;
+
+        int minX, minZ, maxX, maxZ;
+        clusterBounds(cluster, minX, minZ, maxX, maxZ);
+
+        // Cluster-local indices keep the whole search inside a few cache lines
+        int size = m_ClusterSize;
+        SearchArena& arena = m_ClusterArena;
+        arena.begin(size, size);
+        arena.pushOrDecrease((z - minZ) * size + (x - minX), 0.0f, 0.0f, -1);
+
+        // Stop as soon as every entrance of the cluster is settled
+        size_t remaining = nodes.size();
+
+        while (!arena.openEmpty()) {
+            int current = arena.popMin();
+            arena.close(current);
+
+            int cx = minX + current % size;
+            int cz = minZ + current / size;
+
+            for (int id : nodes) {
+                if (m_Nodes[id].x == cx && m_Nodes[id].z == cz) remaining--;
+            }
+            if (remaining == 0) break;
+
+            float g = arena.g(current);
+
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    if (dx == 0 && dz == 0) continue;
+                    int nx = cx + dx, nz = cz + dz;
+                    if (nx < minX || nx > maxX || nz < minZ || nz > maxZ) continue;
+                    if (!isWalkable(nx, nz)) continue;
+                    arena.pushOrDecrease((nz - minZ) * size + (nx - minX), g + ((dx != 0 && dz != 0) ? 1.414f : 1.0f), 0.0f, current);
+                }
+            }
+        }
+
+        for (int id : nodes) {
+            int idx = (m_Nodes[id].z - minZ) * size + (m_Nodes[id].x - minX);
+            if (arena.isClosed(idx)) out.push_back({ id, arena.g(idx) });
+        }
+    }
+
+    // A* confined to one cluster; appends cells (start excluded) to path
+    bool searchInCluster(int startX, int startZ, int targetX, int targetZ, int cluster,
+        std::vector<glm::vec3>& path, int& nodesExpanded)
+    {
+        int minX, minZ, maxX, maxZ;
+        clusterBounds(cluster, minX, minZ, maxX, maxZ);
+
+        SearchArena& arena = SearchArena::local();
+        arena.begin(m_Width, m_Height);
+        int targetIdx = targetZ * m_Width + targetX;
+        arena.pushOrDecrease(startZ * m_Width + startX, 0.0f, distance(startX, startZ, targetX, targetZ), -1);
+
+        bool found = false;
+        while (!arena.openEmpty()) {
+            int current = arena.popMin();
+            arena.close(current);
+            nodesExpanded++;
+            if (current == targetIdx) { found = true; break; }
+
+            int cx = current % m_Width;
+            int cz = current / m_Width;
+            float g = arena.g(current);
+
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    if (dx == 0 && dz == 0) continue;
+                    int nx = cx + dx, nz = cz + dz;
+                    if (nx < minX || nx > maxX || nz < minZ || nz > maxZ) continue;
+                    if (!isWalkable(nx, nz)) continue;
+                    int idx = nz * m_Width + nx;
+                    if (arena.isClosed(idx)) continue;
+                    arena.pushOrDecrease(idx, g + ((dx != 0 && dz != 0) ? 1.414f : 1.0f), distance(nx, nz, targetX, targetZ), current);
+                }
+            }
+        }
+        if (!found) return false;
+
+        size_t first = path.size();
+        for (int idx = targetIdx; arena.parent(idx) != -1; idx = arena.parent(idx)) {
+            path.push_back(glm::vec3(idx % m_Width, 0.0f, idx / m_Width));
+        }
+        std::reverse(path.begin() + first, path.end());
+        return true;
+    }
+};
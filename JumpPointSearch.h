@@ -0,0 +1,173 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "SearchArena.h"
+
+// Jump Point Search over a uniform-cost, 8-connected grid.
+// Straight and diagonal runs of identical cells are skipped in one "jump", so only
+// cells where the optimal route may turn (jump points) are pushed to the open list.
+// Diagonal moves are allowed past corners, exactly like the neighbour loop in
+// Pathfinder's A*, so both modes see the same set of legal moves.
+//
+// Walkable must provide: bool operator()(int x, int z) const
+class JumpPointSearch {
+public:
+    // Returns per-cell waypoints (start excluded, goal included), empty if no path.
+    // nodesExpanded receives the number of jump points taken from the open list.
+    template <class Walkable>
+    static std::vector<glm::vec3> findPath(int startX, int startZ, int targetX, int targetZ,
+        int width, int height, const Walkable& walkable, int maxExpansions, int& nodesExpanded)
+    {
+        std::vector<glm::vec3> path;
+        nodesExpanded = 0;
+
+        SearchArena& arena = SearchArena::local();
+        arena.begin(width, height);
+
+        int startIdx = startZ * width + startX;
+        int targetIdx = targetZ * width + targetX;
+        arena.pushOrDecrease(startIdx, 0.0f, distance(startX, startZ, targetX, targetZ), -1);
+
+        int finalIdx = -1;
+
+        while (!arena.openEmpty()) {
+            int currentIdx = arena.popMin();
+            arena.close(currentIdx);
+            nodesExpanded++;
+
+            if (currentIdx == targetIdx) {
+                finalIdx = currentIdx;
+                break;
+            }
+
+            // Safety Cutoff
+            if (nodesExpanded > maxExpansions) break;
+
+            int cx = currentIdx % width;
+            int cz = currentIdx / width;
+            int parentIdx = arena.parent(currentIdx);
+
+            // Directions worth exploring from here (pruned by where we came from)
+            int dirs[8][2];
+            int dirCount = 0;
+
+            if (parentIdx == -1) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    for (int dz = -1; dz <= 1; dz++) {
+                        if (dx == 0 && dz == 0) continue;
+                        dirs[dirCount][0] = dx; dirs[dirCount][1] = dz; dirCount++;
+                    }
+                }
+            }
+            else {
+                int dx = sign(cx - parentIdx % width);
+                int dz = sign(cz - parentIdx / width);
+
+                if (dx != 0 && dz != 0) {
+                    // Diagonal: natural neighbours + forced ones around blocked corners
+                    dirs[dirCount][0] = dx; dirs[dirCount][1] = dz; dirCount++;
+                    dirs[dirCount][0] = dx; dirs[dirCount][1] = 0;  dirCount++;
+                    dirs[dirCount][0] = 0;  dirs[dirCount][1] = dz; dirCount++;
+                    if (!walkable(cx - dx, cz)) { dirs[dirCount][0] = -dx; dirs[dirCount][1] = dz; dirCount++; }
+                    if (!walkable(cx, cz - dz)) { dirs[dirCount][0] = dx; dirs[dirCount][1] = -dz; dirCount++; }
+                }
+                else if (dx != 0) {
+                    dirs[dirCount][0] = dx; dirs[dirCount][1] = 0; dirCount++;
+                    if (!walkable(cx, cz + 1)) { dirs[dirCount][0] = dx; dirs[dirCount][1] = 1; dirCount++; }
+                    if (!walkable(cx, cz - 1)) { dirs[dirCount][0] = dx; dirs[dirCount][1] = -1; dirCount++; }
+                }
+                else {
+                    dirs[dirCount][0] = 0; dirs[dirCount][1] = dz; dirCount++;
+                    if (!walkable(cx + 1, cz)) { dirs[dirCount][0] = 1; dirs[dirCount][1] = dz; dirCount++; }
+                    if (!walkable(cx - 1, cz)) { dirs[dirCount][0] = -1; dirs[dirCount][1] = dz; dirCount++; }
+                }
+            }
+
+            float currentG = arena.g(currentIdx);
+
+            for (int i = 0; i < dirCount; i++) {
+                int jx, jz;
+                if (!jump(cx, cz, dirs[i][0], dirs[i][1], targetX, targetZ, walkable, jx, jz)) continue;
+
+                int jumpIdx = jz * width + jx;
+                if (arena.isClosed(jumpIdx)) continue;
+
+                float newGCost = currentG + octile(jx - cx, jz - cz);
+                arena.pushOrDecrease(jumpIdx, newGCost, distance(jx, jz, targetX, targetZ), currentIdx);
+            }
+        }
+
+        // Reconstruct Path (fill in the cells between consecutive jump points)
+        if (finalIdx != -1) {
+            for (int idx = finalIdx; arena.parent(idx) != -1; idx = arena.parent(idx)) {
+                int parentIdx = arena.parent(idx);
+                int x = idx % width, z = idx / width;
+                int px = parentIdx % width, pz = parentIdx / width;
+                int dx = sign(px - x), dz = sign(pz - z);
+
+                while (x != px || z != pz) {
+                    path.push_back(glm::vec3(x, 0.0f, z));
+                    if (x != px) x += dx;
+                    if (z != pz) z += dz;
+                }
+            }
+            std::reverse(path.begin(), path.end());
+        }
+
+        return path;
+    }
+
+private:
+    static int sign(int v) { return (v > 0) - (v < 0); }
+
+    // Octile distance, matches the 1.0 / 1.414 step costs of the grid
+    static float octile(int dx, int dz) {
+        dx = std::abs(dx); dz = std::abs(dz);
+        return (float)std::max(dx, dz) + 0.414f * (float)std::min(dx, dz);
+    }
+
+    static float distance(int x, int z, int tx, int tz) {
+        float dx = (float)(x - tx);
+        float dz = (float)(z - tz);
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    // Walk from (x,z) in direction (dx,dz) until we hit a jump point, the goal, or a wall
+    template <class Walkable>
+    static bool jump(int x, int z, int dx, int dz, int targetX, int targetZ,
+        const Walkable& walkable, int& outX, int& outZ)
+    {
+        while (true) {
+            x += dx;
+            z += dz;
+            if (!walkable(x, z)) return false;
+
+            if (x == targetX && z == targetZ) break;
+
+            if (dx != 0 && dz != 0) {
+                // Forced neighbours around a blocked corner
+                if ((walkable(x - dx, z + dz) && !walkable(x - dx, z)) ||
+                    (walkable(x + dx, z - dz) && !walkable(x, z - dz))) break;
+
+                // A straight run from here reaches a jump point
+                int sx, sz;
+                if (jump(x, z, dx, 0, targetX, targetZ, walkable, sx, sz) ||
+                    jump(x, z, 0, dz, targetX, targetZ, walkable, sx, sz)) break;
+            }
+            else if (dx != 0) {
+                if ((walkable(x + dx, z + 1) && !walkable(x, z + 1)) ||
+                    (walkable(x + dx, z - 1) && !walkable(x, z - 1))) break;
+            }
+            else {
+                if ((walkable(x + 1, z + dz) && !walkable(x + 1, z)) ||
+                    (walkable(x - 1, z + dz) && !walkable(x - 1, z))) break;
+            }
+        }
+        outX = x;
+        outZ = z;
+        return true;
+    }
+};
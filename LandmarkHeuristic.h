@@ -0,0 +1,284 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include <cfloat>
+#include <algorithm>
+#include "NavigationGrid.h"
+#include "SearchArena.h"
+
+// ALT heuristic (A*, Landmarks, Triangle inequality) over a NavigationGrid.
+// We pick a few landmark cells spread around the edge of the map and store the
+// walking distance from each of them to every cell. For any landmark L the
+// triangle inequality gives |d(L,n) - d(L,goal)| <= d(n,goal), so the largest of
+// those differences is a lower bound that already knows about the rock fields a
+// straight line would cut through.
+//
+// The map is mostly static, so the tables are not kept exact. New obstacles only
+// add up the changed area; once it passes STALE_CELLS, update() rebuilds every
+// table a few thousand cells per frame into a fresh copy and swaps it in whole.
+// Until then searches keep using the old tables, which stay admissible: extra
+// walls only make real distances longer. Clearing a cell the tables treated as a
+// wall (a felled tree, a destroyed building) is different: a real route through
+// it can be shorter than the tables say, and the bound could overestimate. So the
+// first such cell drops the tables on the spot (new searches fall back to the
+// straight line; one already running keeps its table to the end, at worst finding
+// a slightly longer path) and starts a rebuild from the new grid.
+// Searches on path worker threads take their own reference to the current table,
+// so a swap never changes the table under a running search.
+class LandmarkHeuristic {
+public:
+    enum {
+        LANDMARK_COUNT = 8,
+        STALE_CELLS = 1024,           // Changed cells (new walls) before the tables are rebuilt
+        UNREACHED = 0xFFFF
+    };
+
+    // Distances in 1/16 cells, cell-major (the LANDMARK_COUNT values of one cell are adjacent)
+    struct Table {
+        int width = 0, height = 0;
+        std::vector<uint16_t> dist;
+        std::vector<int> landmarks;   // Cell index of each landmark
+    };
+
+    // Lower bound to one goal, for the duration of one search
+    class Estimate {
+    public:
+        Estimate() {}
+        Estimate(std::shared_ptr<const Table> table, int goalIdx) : m_Table(std::move(table)) {
+            if (!m_Table) return;
+            const uint16_t* goal = &m_Table->dist[(size_t)goalIdx * LANDMARK_COUNT];
+            for (int k = 0; k < LANDMARK_COUNT; k++) m_Goal[k] = goal[k];
+        }
+
+        bool valid() const { return (bool)m_Table; }
+
+        float at(int idx) const {
+            const uint16_t* cell = &m_Table->dist[(size_t)idx * LANDMARK_COUNT];
+            int best = 0;
+            for (int k = 0; k < LANDMARK_COUNT; k++) {
+                if (cell[k] == UNREACHED || m_Goal[k] == UNREACHED) continue;
+                best = std::max(best, std::abs((int)cell[k] - (int)m_Goal[k]));
+            }
+            // Both ends were rounded down, so the difference can be one step too large
+            return (best > 0) ? (best - 1) * (1.0f / 16.0f) : 0.0f;
+        }
+
+    private:
+        std::shared_ptr<const Table> m_Table;
+        int m_Goal[LANDMARK_COUNT];
+    };
+
+    LandmarkHeuristic(NavigationGrid* grid, int borderSize) : m_Grid(grid), m_BorderSize(borderSize) {
+        m_ListenerID = m_Grid->addChangeListener([this](int minX, int minZ, int maxX, int maxZ) {
+            m_ChangedCells += (maxX - minX + 1) * (maxZ - minZ + 1);
+            if (clearsWall(minX, minZ, maxX, maxZ)) discardTables();
+        });
+
+        // First build runs to completion (the map bake is done by now)
+        m_ChangedCells = STALE_CELLS;
+        update(-1);
+    }
+
+    ~LandmarkHeuristic() {
+        m_Grid->removeChangeListener(m_ListenerID);
+    }
+
+    LandmarkHeuristic(const LandmarkHeuristic&) = delete;
+    LandmarkHeuristic& operator=(const LandmarkHeuristic&) = delete;
+
+    // Main thread, once per rendered frame: advance a pending rebuild by at most `budget`
+    // expanded cells (negative = finish it now)
+    void update(int budget) {
+        if (!m_Pending) {
+            if (m_ChangedCells < STALE_CELLS) return;
+            m_ChangedCells = 0;
+            beginBuild();
+            if (!m_Pending) return;
+        }
+
+        int expanded = 0;
+        while (budget < 0 || expanded < budget) {
+            if (m_Arena.openEmpty()) {
+                if (!nextLandmark()) {
+                    std::shared_ptr<const Table> done = std::move(m_Pending);
+                    m_CurrentWalls.swap(m_PendingWalls);
+                    std::lock_guard<std::mutex> lock(m_Mutex);
+                    m_Current = done;
+                    m_Builds++;
+                    return;
+                }
+                continue;
+            }
+            expand();
+            expanded++;
+        }
+    }
+
+    // Table for a search on a grid of this size, nullptr if there is none (yet)
+    std::shared_ptr<const Table> getTable(int width, int height) const {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Current || m_Current->width != width || m_Current->height != height) return nullptr;
+        return m_Current;
+    }
+
+    // --- Stats ---
+    int getBuildCount() const { return m_Builds; }
+    int getDiscardCount() const { return m_Discards; }
+    bool isRebuilding() const { return (bool)m_Pending; }
+
+private:
+    NavigationGrid* m_Grid;
+    int m_BorderSize;
+    int m_ListenerID = -1;
+    int m_ChangedCells = 0;           // Main thread only (set by the grid listener)
+    int m_Builds = 0;
+    int m_Discards = 0;
+
+    // Cells each table was built around as walls: for the current table, the walls
+    // when its build started; for the pending one, every cell that has been a wall
+    // at any point of its (sliced) build. Main thread only.
+    std::vector<bool> m_CurrentWalls;
+    std::vector<bool> m_PendingWalls;
+
+    mutable std::mutex m_Mutex;
+    std::shared_ptr<const Table> m_Current;
+
+    // Rebuild in progress: one Dijkstra per landmark, run in slices by update()
+    std::shared_ptr<Table> m_Pending;
+    SearchArena m_Arena;
+    int m_Landmark = -1;              // Landmark whose distances are being filled in
+    std::vector<float> m_Nearest;     // Distance from each cell to its closest landmark so far
+
+    bool isWalkable(int x, int z) const {
+        if (x < m_BorderSize || x >= m_Grid->getWidth() - m_BorderSize ||
+            z < m_BorderSize || z >= m_Grid->getHeight() - m_BorderSize) return false;
+        return !m_Grid->isBlocked(x, z);
+    }
+
+    // Records new walls for the pending build; true if the change cleared a cell
+    // the current or pending table treats as a wall
+    bool clearsWall(int minX, int minZ, int maxX, int maxZ) {
+        int width = m_Grid->getWidth();
+        minX = std::max(minX, 0);
+        minZ = std::max(minZ, 0);
+        maxX = std::min(maxX, width - 1);
+        maxZ = std::min(maxZ, m_Grid->getHeight() - 1);
+        bool cleared = false;
+        for (int z = minZ; z <= maxZ; z++) {
+            for (int x = minX; x <= maxX; x++) {
+                size_t idx = (size_t)z * width + x;
+                if (!isWalkable(x, z)) {
+                    if (m_Pending) m_PendingWalls[idx] = true;
+                }
+                else if ((m_Current && m_CurrentWalls[idx]) || (m_Pending && m_PendingWalls[idx])) {
+                    cleared = true;
+                }
+            }
+        }
+        return cleared;
+    }
+
+    // Stop handing out tables that may overestimate, and rebuild from scratch
+    void discardTables() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Current.reset();
+        }
+        m_Pending.reset();
+        m_ChangedCells = STALE_CELLS;
+        m_Discards++;
+    }
+
+    void beginBuild() {
+        int width = m_Grid->getWidth(), height = m_Grid->getHeight();
+
+        // First landmark: the walkable cell of the largest region closest to one corner
+        int first = -1, bestSize = 0, bestCorner = 0;
+        for (int z = m_BorderSize; z < height - m_BorderSize; z++) {
+            for (int x = m_BorderSize; x < width - m_BorderSize; x++) {
+                if (!isWalkable(x, z)) continue;
+                int size = m_Grid->getRegionSize(m_Grid->getRegion(x, z));
+                if (size > bestSize || (size == bestSize && x + z < bestCorner)) {
+                    first = z * width + x;
+                    bestSize = size;
+                    bestCorner = x + z;
+                }
+            }
+        }
+        if (first == -1) return;
+
+        m_PendingWalls.assign((size_t)width * height, false);
+        for (int z = 0; z < height; z++) {
+            for (int x = 0; x < width; x++) {
+                if (!isWalkable(x, z)) m_PendingWalls[(size_t)z * width + x] = true;
+            }
+        }
+
+        m_Pending = std::make_shared<Table>();
+        m_Pending->width = width;
+        m_Pending->height = height;
+        m_Pending->dist.assign((size_t)width * height * LANDMARK_COUNT, (uint16_t)UNREACHED);
+        m_Nearest.assign((size_t)width * height, FLT_MAX);
+        m_Landmark = -1;
+        startLandmark(first);
+    }
+
+    void startLandmark(int idx) {
+        m_Landmark++;
+        m_Pending->landmarks.push_back(idx);
+        m_Arena.begin(m_Pending->width, m_Pending->height);
+        m_Arena.pushOrDecrease(idx, 0.0f, 0.0f, -1);
+    }
+
+    // Current landmark finished: place the next one as far as possible from all
+    // the others. Returns false once every landmark is done.
+    bool nextLandmark() {
+        if (m_Landmark + 1 >= LANDMARK_COUNT) return false;
+
+        int best = -1;
+        float bestDist = 0.0f;
+        const uint16_t* dist = m_Pending->dist.data();
+        for (size_t i = 0; i < m_Nearest.size(); i++) {
+            if (dist[i * LANDMARK_COUNT] == UNREACHED) continue; // Not in the first landmark's area
+            if (m_Nearest[i] > bestDist) {
+                best = (int)i;
+                bestDist = m_Nearest[i];
+            }
+        }
+        if (best == -1) return false;
+
+        startLandmark(best);
+        return true;
+    }
+
+    // One Dijkstra step of the current landmark
+    void expand() {
+        int width = m_Pending->width;
+        int currentIdx = m_Arena.popMin();
+        m_Arena.close(currentIdx);
+
+        float currentG = m_Arena.g(currentIdx);
+        float fixed = currentG * 16.0f;
+        if (fixed < (float)UNREACHED) m_Pending->dist[(size_t)currentIdx * LANDMARK_COUNT + m_Landmark] = (uint16_t)fixed;
+        m_Nearest[currentIdx] = std::min(m_Nearest[currentIdx], currentG);
+
+        int cx = currentIdx % width;
+        int cz = currentIdx / width;
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dz = -1; dz <= 1; dz++) {
+                if (dx == 0 && dz == 0) continue;
+
+                int nx = cx + dx;
+                int nz = cz + dz;
+                if (!isWalkable(nx, nz)) continue;
+
+                int neighborIdx = nz * width + nx;
+                if (m_Arena.isClosed(neighborIdx)) continue;
+                m_Arena.pushOrDecrease(neighborIdx, currentG + ((dx != 0 && dz != 0) ? 1.414f : 1.0f), 0.0f, currentIdx);
+            }
+        }
+    }
+};
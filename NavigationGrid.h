@@ -2,18 +2,571 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <functional>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
 
 class NavigationGrid {
+public:
+    // Inclusive box of cells touched by one change, stamped with the version it produced
+    struct DirtyRect {
+        uint64_t version;
+        int minX, minZ, maxX, maxZ;
+
+        bool contains(int x, int z) const { return x >= minX && x <= maxX && z >= minZ && z <= maxZ; }
+        bool intersects(int x0, int z0, int x1, int z1) const {
+            return x0 <= maxX && x1 >= minX && z0 <= maxZ && z1 >= minZ;
+        }
+    };
+
 private:
     int m_Width, m_Height;
 
-    // The grid: true = BLOCKED, false = WALKABLE
-    std::vector<bool> m_Grid;
+    // The grid, one bit per cell: 1 = BLOCKED, 0 = WALKABLE.
+    // Rows are padded to whole 64-bit words and wrapped in guard cells that are
+    // always blocked (a full word left and right, GUARD_ROWS above and below), so
+    // neighbour lookups just off the map need no bounds checks and a row span can
+    // be tested or stamped a word at a time.
+    static const int GUARD = 64;
+    static const int GUARD_ROWS = 2;
+    int m_Stride;                  // Words per padded row
+    int m_Origin;                  // Word holding cell (0,0)
+    std::vector<uint64_t> m_Words;
+
+    // x >> 6 rounds down, so the left guard word is index -1 of each row
+    int wordIndex(int x, int z) const { return m_Origin + z * m_Stride + (x >> 6); }
+    static uint64_t bitMask(int x) { return 1ull << (x & 63); }
+
+    // Bits lo..hi (inclusive, 0-63) of one word
+    static uint64_t rangeMask(int lo, int hi) {
+        uint64_t upTo = (hi == 63) ? ~0ull : ((1ull << (hi + 1)) - 1);
+        return upTo & (~0ull << lo);
+    }
+
+    // Set cells x0..x1 of row z (all inside the grid). Returns true if any cell changed.
+    bool writeSpan(int z, int x0, int x1, bool blocked) {
+        int first = x0 + GUARD, last = x1 + GUARD;
+        size_t row = (size_t)(z + GUARD_ROWS) * m_Stride;
+        bool changed = false;
+        for (int w = first >> 6; w <= (last >> 6); w++) {
+            uint64_t mask = rangeMask((w == (first >> 6)) ? (first & 63) : 0, (w == (last >> 6)) ? (last & 63) : 63);
+            uint64_t& word = m_Words[row + w];
+            uint64_t updated = blocked ? (word | mask) : (word & ~mask);
+            changed |= (updated != word);
+            word = updated;
+        }
+        return changed;
+    }
+
+    // True if any cell x0..x1 of row z is blocked; anything off the map counts as blocked
+    bool anyBlockedInSpan(int z, int x0, int x1) const {
+        if (x0 > x1) return false;
+        if (x0 < -GUARD || x1 >= m_Width + GUARD || z < -GUARD_ROWS || z >= m_Height + GUARD_ROWS) return true;
+        int first = x0 + GUARD, last = x1 + GUARD;
+        size_t row = (size_t)(z + GUARD_ROWS) * m_Stride;
+        for (int w = first >> 6; w <= (last >> 6); w++) {
+            uint64_t mask = rangeMask((w == (first >> 6)) ? (first & 63) : 0, (w == (last >> 6)) ? (last & 63) : 63);
+            if (m_Words[row + w] & mask) return true;
+        }
+        return false;
+    }
+
+    // Everything blocked, then open up the map itself (guards stay blocked)
+    void resetWords() {
+        m_Stride = (m_Width + 2 * GUARD + 63) / 64;
+        m_Origin = GUARD_ROWS * m_Stride + GUARD / 64;
+        m_Words.assign((size_t)m_Stride * (m_Height + 2 * GUARD_ROWS), ~0ull);
+        for (int z = 0; z < m_Height; z++) writeSpan(z, 0, m_Width - 1, false);
+    }
+
+    // Half width of row dz of a circle, matching glm::distance(cell, center) <= radius. -1 if the row is empty.
+    static int circleHalfWidth(int dz, float radius) {
+        float rest = radius * radius - (float)(dz * dz);
+        int dx = (rest > 0.0f) ? (int)std::sqrt(rest) : 0;
+        while (glm::length(glm::vec2(dx + 1, dz)) <= radius) dx++;
+        while (dx >= 0 && glm::length(glm::vec2(dx, dz)) > radius) dx--;
+        return dx;
+    }
+
+    // Called with the bounding box (inclusive) of every change
+    struct Listener {
+        int id;
+        std::function<void(int minX, int minZ, int maxX, int maxZ)> callback;
+    };
+    std::vector<Listener> m_Listeners;
+    int m_NextListenerID = 0;
+
+    // Version bumps on every change; the last few changed boxes are kept so
+    // callers holding an older version can ask what changed since then
+    uint64_t m_Version = 0;
+    static const size_t HISTORY_SIZE = 64;
+    std::vector<DirtyRect> m_History; // Ring buffer, newest at m_HistoryHead - 1
+    size_t m_HistoryHead = 0;
+
+    // Clearance: Chebyshev distance from each cell to the nearest blocked cell
+    // (0 = blocked, anything off the map counts as blocked), capped at CLEARANCE_CAP.
+    // A cell with clearance c has a free (2c-1) x (2c-1) square around it.
+    // Changes only mark boxes dirty; they are recomputed on the next query.
+    mutable std::vector<uint8_t> m_Clearance;
+    struct Box { int minX, minZ, maxX, maxZ; };
+    mutable std::vector<Box> m_ClearanceDirty;
+    static const size_t MAX_DIRTY_BOXES = 8;
+
+    void markClearanceDirty(int minX, int minZ, int maxX, int maxZ) {
+        // A change can shift clearance up to CLEARANCE_CAP cells away
+        Box box = { std::max(0, minX - CLEARANCE_CAP), std::max(0, minZ - CLEARANCE_CAP),
+                    std::min(m_Width - 1, maxX + CLEARANCE_CAP), std::min(m_Height - 1, maxZ + CLEARANCE_CAP) };
+        if (box.minX > box.maxX || box.minZ > box.maxZ) return;
+
+        m_ClearanceDirty.push_back(box);
+        if (m_ClearanceDirty.size() > MAX_DIRTY_BOXES) {
+            // Too many scattered changes (map bake): merge into one box
+            Box merged = m_ClearanceDirty[0];
+            for (const auto& b : m_ClearanceDirty) {
+                merged.minX = std::min(merged.minX, b.minX); merged.minZ = std::min(merged.minZ, b.minZ);
+                merged.maxX = std::max(merged.maxX, b.maxX); merged.maxZ = std::max(merged.maxZ, b.maxZ);
+            }
+            m_ClearanceDirty.assign(1, merged);
+        }
+    }
+
+    void refreshClearance() const {
+        for (const auto& b : m_ClearanceDirty) recomputeClearance(b);
+        m_ClearanceDirty.clear();
+    }
+
+    int storedClearance(int x, int z) const {
+        if ((unsigned)x >= (unsigned)m_Width || (unsigned)z >= (unsigned)m_Height) return 0;
+        return m_Clearance[z * m_Width + x];
+    }
+
+    // Two-pass chessboard distance transform over the box. Cells outside it are
+    // already correct and act as fixed boundary values.
+    void recomputeClearance(const Box& b) const {
+        for (int z = b.minZ; z <= b.maxZ; z++) {
+            for (int x = b.minX; x <= b.maxX; x++) {
+                int d = 0;
+                if (!isBlockedUnchecked(x, z)) {
+                    d = std::min(storedClearance(x - 1, z), storedClearance(x - 1, z - 1));
+                    d = std::min(d, std::min(storedClearance(x, z - 1), storedClearance(x + 1, z - 1)));
+                    d++;
+                    if (d > CLEARANCE_CAP) d = CLEARANCE_CAP;
+                }
+                m_Clearance[z * m_Width + x] = (uint8_t)d;
+            }
+        }
+        for (int z = b.maxZ; z >= b.minZ; z--) {
+            for (int x = b.maxX; x >= b.minX; x--) {
+                int d = m_Clearance[z * m_Width + x];
+                if (d == 0) continue;
+                d = std::min(d, storedClearance(x + 1, z) + 1);
+                d = std::min(d, storedClearance(x + 1, z + 1) + 1);
+                d = std::min(d, storedClearance(x, z + 1) + 1);
+                d = std::min(d, storedClearance(x - 1, z + 1) + 1);
+                m_Clearance[z * m_Width + x] = (uint8_t)d;
+            }
+        }
+    }
+
+    // Regions: connected groups of walkable cells, 8-connected like the A* grid, so
+    // cells with different labels can never reach each other. Label 0 = blocked
+    // (or, if the map ever runs out of labels, not labelled).
+    // Updated lazily and locally: unblocked cells join and merge the regions they
+    // touch, and blocking cells only floods as far as needed to tell whether (and
+    // which) pieces of a region were cut off.
+    struct Region { int size, minX, minZ, maxX, maxZ; };
+    mutable std::vector<uint16_t> m_RegionLabel;
+    mutable std::vector<Region> m_Regions;         // By label, [0] unused
+    mutable std::vector<uint16_t> m_FreeLabels;
+    mutable std::vector<Box> m_RegionDirty;
+    mutable bool m_RegionsInvalid = true;          // Label the whole map on the next query
+    mutable std::vector<int> m_RegionStack;        // Flood scratch
+    mutable std::vector<uint32_t> m_RegionVisit;   // Split floods: visited mark, stamped per split
+    mutable std::vector<int> m_RegionOwner;        // Split floods: which flood reached the cell
+    mutable uint32_t m_RegionStamp = 0;
+
+    Box clipBox(int minX, int minZ, int maxX, int maxZ) const {
+        Box box = { std::max(0, minX), std::max(0, minZ), std::min(m_Width - 1, maxX), std::min(m_Height - 1, maxZ) };
+        return box;
+    }
+
+    void markRegionDirty(int minX, int minZ, int maxX, int maxZ) {
+        if (m_RegionsInvalid) return;
+        Box box = clipBox(minX, minZ, maxX, maxZ);
+        if (box.minX > box.maxX || box.minZ > box.maxZ) return;
+
+        // Boxes that touch are merged, so both sides of any cut lie around one box
+        // (splitRegion only looks at the cells around a single box)
+        for (size_t i = 0; i < m_RegionDirty.size();) {
+            const Box& o = m_RegionDirty[i];
+            if (o.minX <= box.maxX + 1 && o.maxX >= box.minX - 1 && o.minZ <= box.maxZ + 1 && o.maxZ >= box.minZ - 1) {
+                box.minX = std::min(box.minX, o.minX); box.minZ = std::min(box.minZ, o.minZ);
+                box.maxX = std::max(box.maxX, o.maxX); box.maxZ = std::max(box.maxZ, o.maxZ);
+                m_RegionDirty.erase(m_RegionDirty.begin() + i);
+                i = 0;
+            }
+            else {
+                i++;
+            }
+        }
+
+        m_RegionDirty.push_back(box);
+        // Map bake or a burst of changes: cheaper to label everything once
+        if (m_RegionDirty.size() > MAX_DIRTY_BOXES) {
+            m_RegionsInvalid = true;
+            m_RegionDirty.clear();
+        }
+    }
+
+    void refreshRegions() const {
+        if (!m_RegionsInvalid) updateRegions();
+        if (m_RegionsInvalid) relabelAllRegions();
+        m_RegionDirty.clear();
+    }
+
+    // 0 if all 65535 labels are in use
+    uint16_t allocRegion() const {
+        if (!m_FreeLabels.empty()) {
+            uint16_t label = m_FreeLabels.back();
+            m_FreeLabels.pop_back();
+            return label;
+        }
+        if (m_Regions.size() > 0xFFFF) return 0;
+        m_Regions.push_back(Region());
+        return (uint16_t)(m_Regions.size() - 1);
+    }
+
+    void freeRegion(uint16_t label) const {
+        m_Regions[label].size = 0;
+        m_FreeLabels.push_back(label);
+    }
+
+    // Give `label` to every unlabelled walkable cell connected to (x,z).
+    // Other labels met on the way are collected in `touched`.
+    void floodRegion(int x, int z, uint16_t label, std::vector<uint16_t>* touched) const {
+        Region& region = m_Regions[label];
+        region.size = 0;
+        region.minX = region.maxX = x;
+        region.minZ = region.maxZ = z;
+
+        m_RegionLabel[z * m_Width + x] = label;
+        m_RegionStack.assign(1, z * m_Width + x);
+        while (!m_RegionStack.empty()) {
+            int idx = m_RegionStack.back();
+            m_RegionStack.pop_back();
+            int cx = idx % m_Width, cz = idx / m_Width;
+
+            region.size++;
+            region.minX = std::min(region.minX, cx); region.maxX = std::max(region.maxX, cx);
+            region.minZ = std::min(region.minZ, cz); region.maxZ = std::max(region.maxZ, cz);
+
+            for (int dz = -1; dz <= 1; dz++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int nx = cx + dx, nz = cz + dz;
+                    if (isBlocked(nx, nz)) continue;
+
+                    uint16_t& other = m_RegionLabel[nz * m_Width + nx];
+                    if (other == 0) {
+                        other = label;
+                        m_RegionStack.push_back(nz * m_Width + nx);
+                    }
+                    else if (other != label && touched &&
+                             std::find(touched->begin(), touched->end(), other) == touched->end()) {
+                        touched->push_back(other);
+                    }
+                }
+            }
+        }
+    }
+
+    // Relabel the cells of `from` (within its box) as `into`
+    void mergeRegion(uint16_t from, uint16_t into) const {
+        Region& src = m_Regions[from];
+        Region& dst = m_Regions[into];
+        for (int z = src.minZ; z <= src.maxZ; z++) {
+            for (int x = src.minX; x <= src.maxX; x++) {
+                uint16_t& label = m_RegionLabel[z * m_Width + x];
+                if (label == from) label = into;
+            }
+        }
+        dst.size += src.size;
+        dst.minX = std::min(dst.minX, src.minX); dst.maxX = std::max(dst.maxX, src.maxX);
+        dst.minZ = std::min(dst.minZ, src.minZ); dst.maxZ = std::max(dst.maxZ, src.maxZ);
+        freeRegion(from);
+    }
+
+    // Blocking cells in `box` may have cut region `label` apart. Flood outwards from
+    // each of its cells around the box at once, one cell per flood in turn; floods
+    // that meet belong to the same piece. Once at most one piece is still growing,
+    // every other piece is complete and gets a new label. So the cost is the size of
+    // the cut-off pieces, and when nothing was cut the floods meet right around the box.
+    void splitRegion(const Box& box, uint16_t label) const {
+        struct Flood {
+            std::vector<int> cells; // Visited, in BFS order (also the queue)
+            size_t head;
+            int parent;             // Union-find over floods that met
+        };
+        std::vector<Flood> floods;
+
+        if (m_RegionVisit.size() != m_RegionLabel.size()) {
+            m_RegionVisit.assign(m_RegionLabel.size(), 0);
+            m_RegionOwner.assign(m_RegionLabel.size(), 0);
+        }
+        if (++m_RegionStamp == 0) {
+            std::fill(m_RegionVisit.begin(), m_RegionVisit.end(), 0);
+            m_RegionStamp = 1;
+        }
+
+        Box ring = clipBox(box.minX - 1, box.minZ - 1, box.maxX + 1, box.maxZ + 1);
+        for (int z = ring.minZ; z <= ring.maxZ; z++) {
+            for (int x = ring.minX; x <= ring.maxX; x++) {
+                int idx = z * m_Width + x;
+                if (m_RegionLabel[idx] != label) continue;
+                m_RegionVisit[idx] = m_RegionStamp;
+                m_RegionOwner[idx] = (int)floods.size();
+                Flood flood = { std::vector<int>(1, idx), 0, (int)floods.size() };
+                floods.push_back(flood);
+            }
+        }
+        if (floods.size() <= 1) return;
+
+        auto root = [&floods](int f) {
+            while (floods[f].parent != f) f = floods[f].parent = floods[floods[f].parent].parent;
+            return f;
+        };
+
+        std::vector<char> seen(floods.size());
+        int growing = 0, growingRoot = -1;
+        while (true) {
+            std::fill(seen.begin(), seen.end(), 0);
+            growing = 0;
+            for (int f = 0; f < (int)floods.size(); f++) {
+                if (floods[f].head == floods[f].cells.size()) continue;
+                int r = root(f);
+                if (!seen[r]) { seen[r] = 1; growing++; growingRoot = r; }
+            }
+            if (growing <= 1) break;
+
+            for (int f = 0; f < (int)floods.size(); f++) {
+                if (floods[f].head == floods[f].cells.size()) continue;
+                int idx = floods[f].cells[floods[f].head++];
+                int cx = idx % m_Width, cz = idx / m_Width;
+
+                for (int dz = -1; dz <= 1; dz++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        int nx = cx + dx, nz = cz + dz;
+                        if ((unsigned)nx >= (unsigned)m_Width || (unsigned)nz >= (unsigned)m_Height) continue;
+
+                        int n = nz * m_Width + nx;
+                        if (m_RegionLabel[n] != label) continue;
+                        if (m_RegionVisit[n] != m_RegionStamp) {
+                            m_RegionVisit[n] = m_RegionStamp;
+                            m_RegionOwner[n] = f;
+                            floods[f].cells.push_back(n);
+                        }
+                        else {
+                            int a = root(f), b = root(m_RegionOwner[n]);
+                            if (a != b) floods[a].parent = b;
+                        }
+                    }
+                }
+            }
+        }
+
+        // The piece still growing keeps the label; if every piece finished, the biggest does
+        std::vector<int> pieceSize(floods.size(), 0);
+        for (int f = 0; f < (int)floods.size(); f++) pieceSize[root(f)] += (int)floods[f].cells.size();
+        int keep = growingRoot;
+        if (growing == 0) {
+            for (int f = 0; f < (int)floods.size(); f++) {
+                if (keep == -1 || pieceSize[f] > pieceSize[keep]) keep = f;
+            }
+        }
+
+        std::vector<uint16_t> pieceLabel(floods.size(), 0);
+        for (int f = 0; f < (int)floods.size(); f++) {
+            int r = root(f);
+            if (r == keep) continue;
+
+            if (pieceLabel[r] == 0) {
+                pieceLabel[r] = allocRegion();
+                if (pieceLabel[r] == 0) { m_RegionsInvalid = true; return; }
+                int first = floods[f].cells[0];
+                Region piece = { 0, first % m_Width, first / m_Width, first % m_Width, first / m_Width };
+                m_Regions[pieceLabel[r]] = piece;
+            }
+
+            Region& piece = m_Regions[pieceLabel[r]];
+            for (int idx : floods[f].cells) {
+                int x = idx % m_Width, z = idx / m_Width;
+                m_RegionLabel[idx] = pieceLabel[r];
+                piece.size++;
+                piece.minX = std::min(piece.minX, x); piece.maxX = std::max(piece.maxX, x);
+                piece.minZ = std::min(piece.minZ, z); piece.maxZ = std::max(piece.maxZ, z);
+            }
+            m_Regions[label].size -= (int)floods[f].cells.size();
+        }
+    }
+
+    // Apply the dirty boxes to the labels
+    void updateRegions() const {
+        std::vector<char> shrunk(m_RegionDirty.size(), 0);
+
+        // 1. Newly blocked cells leave their region
+        for (size_t i = 0; i < m_RegionDirty.size(); i++) {
+            const Box& b = m_RegionDirty[i];
+            for (int z = b.minZ; z <= b.maxZ; z++) {
+                for (int x = b.minX; x <= b.maxX; x++) {
+                    uint16_t& label = m_RegionLabel[z * m_Width + x];
+                    if (label == 0 || !isBlockedUnchecked(x, z)) continue;
+                    if (--m_Regions[label].size == 0) freeRegion(label);
+                    label = 0;
+                    shrunk[i] = 1;
+                }
+            }
+        }
+
+        // 2. Newly walkable cells become a region, merged into every region they touch
+        std::vector<uint16_t> touched;
+        for (const auto& b : m_RegionDirty) {
+            for (int z = b.minZ; z <= b.maxZ; z++) {
+                for (int x = b.minX; x <= b.maxX; x++) {
+                    if (isBlockedUnchecked(x, z) || m_RegionLabel[z * m_Width + x] != 0) continue;
+
+                    uint16_t label = allocRegion();
+                    if (label == 0) { m_RegionsInvalid = true; return; }
+                    touched.clear();
+                    floodRegion(x, z, label, &touched);
+
+                    // Keep the biggest label, so merging rewrites as few cells as possible
+                    uint16_t keep = label;
+                    for (uint16_t t : touched) {
+                        if (m_Regions[t].size > m_Regions[keep].size) keep = t;
+                    }
+                    touched.push_back(label);
+                    for (uint16_t t : touched) {
+                        if (t != keep) mergeRegion(t, keep);
+                    }
+                }
+            }
+        }
+
+        // 3. Regions that lost cells may have been cut in two
+        std::vector<uint16_t> around;
+        for (size_t i = 0; i < m_RegionDirty.size(); i++) {
+            if (!shrunk[i]) continue;
+            const Box& b = m_RegionDirty[i];
+            Box ring = clipBox(b.minX - 1, b.minZ - 1, b.maxX + 1, b.maxZ + 1);
+
+            around.clear();
+            for (int z = ring.minZ; z <= ring.maxZ; z++) {
+                for (int x = ring.minX; x <= ring.maxX; x++) {
+                    uint16_t label = m_RegionLabel[z * m_Width + x];
+                    if (label != 0 && std::find(around.begin(), around.end(), label) == around.end()) around.push_back(label);
+                }
+            }
+            for (uint16_t label : around) {
+                splitRegion(b, label);
+                if (m_RegionsInvalid) return;
+            }
+        }
+    }
+
+    void relabelAllRegions() const {
+        m_RegionsInvalid = false;
+        m_RegionLabel.assign((size_t)m_Width * m_Height, 0);
+        m_Regions.assign(1, Region());
+        m_FreeLabels.clear();
+
+        for (int z = 0; z < m_Height; z++) {
+            for (int x = 0; x < m_Width; x++) {
+                if (isBlockedUnchecked(x, z) || m_RegionLabel[z * m_Width + x] != 0) continue;
+                uint16_t label = allocRegion();
+                if (label == 0) return; // Out of labels: the rest stays 0
+                floodRegion(x, z, label, nullptr);
+            }
+        }
+    }
+
+    void notifyChanged(int minX, int minZ, int maxX, int maxZ) {
+        markClearanceDirty(minX, minZ, maxX, maxZ);
+        markRegionDirty(minX, minZ, maxX, maxZ);
+        m_Version++;
+        DirtyRect rect = { m_Version, minX, minZ, maxX, maxZ };
+        if (m_History.size() < HISTORY_SIZE) m_History.push_back(rect);
+        else m_History[m_HistoryHead] = rect;
+        m_HistoryHead = (m_HistoryHead + 1) % HISTORY_SIZE;
+
+        for (const auto& l : m_Listeners) l.callback(minX, minZ, maxX, maxZ);
+    }
 
 public:
+    static const int CLEARANCE_CAP = 16;
+
     NavigationGrid(int width, int height) : m_Width(width), m_Height(height) {
-        // Initialize entire map as walkable (false)
-        m_Grid.resize(width * height, false);
+        // Initialize entire map as walkable
+        resetWords();
+        m_Clearance.assign((size_t)width * height, 0);
+        markClearanceDirty(0, 0, width - 1, height - 1);
+    }
+
+    // Copies the cells only: listeners stay with the grid they subscribed to.
+    // The clearance map and regions are brought up to date first, so the copy never
+    // has to refresh them (copies are shared read-only between path workers).
+    NavigationGrid(const NavigationGrid& other)
+        : m_Width(other.m_Width), m_Height(other.m_Height), m_Stride(other.m_Stride), m_Origin(other.m_Origin),
+          m_Words(other.m_Words), m_Version(other.m_Version)
+    {
+        other.refreshClearance();
+        m_Clearance = other.m_Clearance;
+
+        other.refreshRegions();
+        m_RegionLabel = other.m_RegionLabel;
+        m_Regions = other.m_Regions;
+        m_FreeLabels = other.m_FreeLabels;
+        m_RegionsInvalid = false;
+    }
+    NavigationGrid& operator=(const NavigationGrid&) = delete;
+
+    int getWidth() const { return m_Width; }
+    int getHeight() const { return m_Height; }
+
+    // Subscribe to cell changes (used by path caches / hierarchies). Returns an id for removal.
+    int addChangeListener(std::function<void(int minX, int minZ, int maxX, int maxZ)> callback) {
+        m_Listeners.push_back({ m_NextListenerID, callback });
+        return m_NextListenerID++;
+    }
+
+    void removeChangeListener(int id) {
+        for (size_t i = 0; i < m_Listeners.size(); i++) {
+            if (m_Listeners[i].id == id) { m_Listeners.erase(m_Listeners.begin() + i); return; }
+        }
+    }
+
+    // Increases by one for every change of the cells
+    uint64_t getVersion() const { return m_Version; }
+
+    // Collect the boxes changed after `version`. Returns false if that is too far
+    // back to tell, in which case the caller should assume everything changed.
+    bool getChangesSince(uint64_t version, std::vector<DirtyRect>& out) const {
+        out.clear();
+        if (version >= m_Version) return true;
+        if (m_Version - version > m_History.size()) return false;
+        for (const auto& rect : m_History) {
+            if (rect.version > version) out.push_back(rect);
+        }
+        return true;
+    }
+
+    // True if any change after `version` touched the given box (inclusive)
+    bool isAreaChangedSince(uint64_t version, int minX, int minZ, int maxX, int maxZ) const {
+        if (version >= m_Version) return false;
+        if (m_Version - version > m_History.size()) return true;
+        for (const auto& rect : m_History) {
+            if (rect.version > version && rect.intersects(minX, minZ, maxX, maxZ)) return true;
+        }
+        return false;
     }
 
     // Helper: 2D Index to 1D Index
@@ -24,15 +577,74 @@ public:
 
     // Check if a tile is blocked
     bool isBlocked(int x, int z) const {
-        int idx = getIndex(x, z);
-        if (idx == -1) return true; // Out of bounds is blocked
-        return m_Grid[idx];
+        // Out of bounds is blocked (one unsigned compare per axis)
+        if ((unsigned)x >= (unsigned)m_Width || (unsigned)z >= (unsigned)m_Height) return true;
+        return (m_Words[wordIndex(x, z)] & bitMask(x)) != 0;
+    }
+
+    // No bounds check: valid up to one cell outside the map (those read as blocked)
+    bool isBlockedUnchecked(int x, int z) const {
+        return (m_Words[wordIndex(x, z)] & bitMask(x)) != 0;
+    }
+
+    // Distance to the nearest blocked (or off-map) cell, 0 if blocked, capped at CLEARANCE_CAP
+    int getClearance(int x, int z) const {
+        if (!m_ClearanceDirty.empty()) refreshClearance();
+        return storedClearance(x, z);
+    }
+
+    // Connected region of the cell (0 = blocked or off the map). Two walkable cells
+    // with different regions can never reach each other.
+    int getRegion(int x, int z) const {
+        if (m_RegionsInvalid || !m_RegionDirty.empty()) refreshRegions();
+        if ((unsigned)x >= (unsigned)m_Width || (unsigned)z >= (unsigned)m_Height) return 0;
+        return m_RegionLabel[z * m_Width + x];
+    }
+
+    // Number of cells in a region returned by getRegion
+    int getRegionSize(int region) const {
+        if (m_RegionsInvalid || !m_RegionDirty.empty()) refreshRegions();
+        if (region <= 0 || region >= (int)m_Regions.size()) return 0;
+        return m_Regions[region].size;
+    }
+
+    // True if the (2*padding+1) square centred on the cell is walkable
+    bool hasClearance(int x, int z, int padding) const {
+        if (padding < CLEARANCE_CAP) return getClearance(x, z) > padding;
+        return isRectFree(x - padding, z - padding, x + padding, z + padding);
+    }
+
+    // True if every cell of the box (inclusive) is walkable
+    bool isRectFree(int minX, int minZ, int maxX, int maxZ) const {
+        for (int z = minZ; z <= maxZ; z++) {
+            if (anyBlockedInSpan(z, minX, maxX)) return false;
+        }
+        return true;
+    }
+
+    // True if every cell updateArea(center, radius) would stamp is walkable
+    bool isCircleFree(glm::vec3 center, float radius) const {
+        int gridX = (int)center.x;
+        int gridZ = (int)center.z;
+        int r = (int)ceil(radius);
+
+        // Usually the clearance map settles it: a free square around the circle,
+        // or a blocked cell close enough to lie inside it (a capped clearance only
+        // says "at least CLEARANCE_CAP", so that one goes to the scan)
+        int c = getClearance(gridX, gridZ);
+        if (c > r && r < CLEARANCE_CAP) return true;
+        if (c < CLEARANCE_CAP && glm::length(glm::vec2(c, c)) <= radius) return false;
+        for (int dz = -r; dz <= r; dz++) {
+            int half = circleHalfWidth(dz, radius);
+            if (half >= 0 && anyBlockedInSpan(gridZ + dz, gridX - half, gridX + half)) return false;
+        }
+        return true;
     }
 
     // Mark a specific spot as Blocked (true) or Walkable (false)
     void setBlocked(int x, int z, bool blocked) {
-        int idx = getIndex(x, z);
-        if (idx != -1) m_Grid[idx] = blocked;
+        if ((unsigned)x >= (unsigned)m_Width || (unsigned)z >= (unsigned)m_Height) return;
+        if (writeSpan(z, x, x, blocked)) notifyChanged(x, z, x, z);
     }
 
     // Mark a circle area (For buildings, explosions, trees)
@@ -41,19 +653,26 @@ public:
         int gridZ = (int)center.z;
         int r = (int)ceil(radius);
 
-        // Loop only through the square bounding box of the circle
-        for (int x = gridX - r; x <= gridX + r; x++) {
-            for (int z = gridZ - r; z <= gridZ + r; z++) {
-                // Precise circle check
-                if (glm::distance(glm::vec2(x, z), glm::vec2(gridX, gridZ)) <= radius) {
-                    setBlocked(x, z, blocked);
-                }
-            }
+        // One span per row of the circle, clipped to the map
+        bool changed = false;
+        for (int dz = -r; dz <= r; dz++) {
+            int z = gridZ + dz;
+            if (z < 0 || z >= m_Height) continue;
+
+            int half = circleHalfWidth(dz, radius);
+            if (half < 0) continue;
+
+            int x0 = std::max(0, gridX - half);
+            int x1 = std::min(m_Width - 1, gridX + half);
+            if (x0 <= x1 && writeSpan(z, x0, x1, blocked)) changed = true;
         }
+        // Re-stamping cells that already had this value is not a change
+        if (changed) notifyChanged(gridX - r, gridZ - r, gridX + r, gridZ + r);
     }
 
     // Clear everything (Reset map)
     void clear() {
-        std::fill(m_Grid.begin(), m_Grid.end(), false);
+        resetWords();
+        notifyChanged(0, 0, m_Width - 1, m_Height - 1);
     }
 };
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Storage for objects of one type, handed out in fixed-size blocks from chunks of
+// BLOCKS_PER_CHUNK. A freed block goes on a free list (linked through the block
+// itself) and is the next one handed out, so once the pool has grown to the peak
+// object count, creating and destroying objects costs no heap allocation. Blocks
+// never move: an object keeps its address for its whole life. Chunks are only
+// released with the pool. Main thread only.
+template <class T>
+class ObjectPool {
+public:
+    enum { BLOCKS_PER_CHUNK = 256 };
+
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Raw memory for one T (construct it with placement new)
+    void* allocate() {
+        if (!m_Free) grow();
+        FreeBlock* block = m_Free;
+        m_Free = block->next;
+        m_Live++;
+        m_Allocated++;
+        return block;
+    }
+
+    void deallocate(void* p) {
+        if (!p) return;
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = m_Free;
+        m_Free = block;
+        m_Live--;
+    }
+
+    size_t getLive() const { return m_Live; }
+    size_t getCapacity() const { return m_Chunks.size() * BLOCKS_PER_CHUNK; }
+    // Chunks taken from the heap so far (the pool's only allocations)
+    size_t getChunkCount() const { return m_Chunks.size(); }
+    // Blocks handed out so far
+    uint64_t getTotalAllocated() const { return m_Allocated; }
+
+private:
+    // A free block holds the link to the next one; a used block holds a T
+    union Block {
+        Block* unused;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    static_assert(sizeof(Block) >= sizeof(FreeBlock), "blocks must fit a free-list link");
+
+    std::vector<std::unique_ptr<Block[]>> m_Chunks;
+    FreeBlock* m_Free = nullptr;
+    size_t m_Live = 0;
+    uint64_t m_Allocated = 0;
+
+    void grow() {
+        m_Chunks.emplace_back(new Block[BLOCKS_PER_CHUNK]);
+        Block* chunk = m_Chunks.back().get();
+        // Thread the new blocks onto the free list, lowest address first
+        for (int i = BLOCKS_PER_CHUNK - 1; i >= 0; i--) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(&chunk[i]);
+            block->next = m_Free;
+            m_Free = block;
+        }
+    }
+};
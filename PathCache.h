@@ -0,0 +1,141 @@
+#pragma once
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "NavigationGrid.h"
+#include "WaypointPath.h"
+
+// Least-recently-used cache of finished paths, keyed by (start cell, goal cell).
+// Paths are handed out as shared WaypointPaths, so every unit that hits the same
+// entry walks one copy.
+// Each entry remembers the bounding box of its cells. A grid change only evicts
+// the entries whose box it overlaps, so building in one corner of the map leaves
+// every path elsewhere cached.
+// Main thread only: lookups, stores and grid notifications all happen there.
+class PathCache {
+public:
+    // Cache used by Unit path requests, nullptr = no caching
+    static PathCache* getActive() { return activeRef(); }
+    static void setActive(PathCache* cache) { activeRef() = cache; }
+
+    PathCache(NavigationGrid* grid, size_t capacity = 256) : m_Grid(grid), m_Capacity(capacity) {
+        m_ListenerID = m_Grid->addChangeListener([this](int minX, int minZ, int maxX, int maxZ) {
+            invalidate(minX, minZ, maxX, maxZ);
+        });
+    }
+
+    ~PathCache() {
+        m_Grid->removeChangeListener(m_ListenerID);
+    }
+
+    PathCache(const PathCache&) = delete;
+    PathCache& operator=(const PathCache&) = delete;
+
+    // Hands out the cached path and marks it recently used
+    bool lookup(const glm::vec3& start, const glm::vec3& target, std::shared_ptr<const WaypointPath>& outPath) {
+        auto it = m_Index.find(makeKey(start, target));
+        if (it == m_Index.end()) {
+            m_Misses++;
+            return false;
+        }
+
+        m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+        outPath = it->second->path;
+        m_Hits++;
+        return true;
+    }
+
+    // Store a path that was searched on the grid as it was at `version`.
+    // Dropped if the grid has since changed under the path (or if it is empty).
+    void store(const glm::vec3& start, const glm::vec3& target, const std::shared_ptr<const WaypointPath>& path, uint64_t version) {
+        if (!path || path->empty()) return;
+
+        Entry entry;
+        entry.key = makeKey(start, target);
+        entry.path = path;
+        entry.minX = entry.maxX = (int)start.x;
+        entry.minZ = entry.maxZ = (int)start.z;
+        for (size_t i = 0; i < path->size(); i++) {
+            glm::vec3 p = (*path)[i];
+            entry.minX = std::min(entry.minX, (int)p.x);
+            entry.maxX = std::max(entry.maxX, (int)p.x);
+            entry.minZ = std::min(entry.minZ, (int)p.z);
+            entry.maxZ = std::max(entry.maxZ, (int)p.z);
+        }
+
+        // Searched on an older copy of the grid: only keep it if nothing it crosses changed
+        if (m_Grid->isAreaChangedSince(version, entry.minX, entry.minZ, entry.maxX, entry.maxZ)) return;
+
+        auto it = m_Index.find(entry.key);
+        if (it != m_Index.end()) {
+            m_Entries.erase(it->second);
+            m_Index.erase(it);
+        }
+
+        m_Entries.push_front(entry);
+        m_Index[entry.key] = m_Entries.begin();
+
+        if (m_Entries.size() > m_Capacity) {
+            m_Index.erase(m_Entries.back().key);
+            m_Entries.pop_back();
+        }
+    }
+
+    void clear() {
+        m_Entries.clear();
+        m_Index.clear();
+    }
+
+    // --- Stats ---
+    size_t size() const { return m_Entries.size(); }
+    int getHits() const { return m_Hits; }
+    int getMisses() const { return m_Misses; }
+    int getInvalidations() const { return m_Invalidations; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        std::shared_ptr<const WaypointPath> path;
+        int minX, minZ, maxX, maxZ; // Box of the start and every corner, so every cell the path crosses
+    };
+
+    static PathCache*& activeRef() {
+        static PathCache* cache = nullptr;
+        return cache;
+    }
+
+    NavigationGrid* m_Grid;
+    int m_ListenerID = -1;
+    size_t m_Capacity;
+
+    std::list<Entry> m_Entries; // Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_Index;
+
+    int m_Hits = 0;
+    int m_Misses = 0;
+    int m_Invalidations = 0;
+
+    static uint64_t makeKey(const glm::vec3& start, const glm::vec3& target) {
+        uint64_t sx = (uint16_t)(int)start.x, sz = (uint16_t)(int)start.z;
+        uint64_t tx = (uint16_t)(int)target.x, tz = (uint16_t)(int)target.z;
+        return (sx << 48) | (sz << 32) | (tx << 16) | tz;
+    }
+
+    // Evict every path whose box overlaps the change
+    void invalidate(int minX, int minZ, int maxX, int maxZ) {
+        for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+            if (it->minX <= maxX && it->maxX >= minX && it->minZ <= maxZ && it->maxZ >= minZ) {
+                m_Index.erase(it->key);
+                it = m_Entries.erase(it);
+                m_Invalidations++;
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+};
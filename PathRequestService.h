@@ -0,0 +1,340 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "NavigationGrid.h"
+#include "Pathfinder.h"
+#include "WaypointPath.h"
+#include "ChasePlanner.h"
+
+enum class PathRequestStatus { PENDING, READY, UNKNOWN };
+
+// Runs Pathfinder::findPath off the main thread.
+// Callers submit a request and get a ticket back, then poll it on later frames.
+// Workers search an immutable copy of the NavigationGrid. The copy is replaced
+// (never edited) after the live grid changes, so a search in flight keeps a
+// consistent map.
+// Finished searches only become READY in applyResults, which the main loop calls
+// once per rendered frame (not per simulation step) with a budget. That spreads large batches of results over
+// several frames.
+// With zero workers, applyResults runs the searches itself on the live grid,
+// a slice at a time: up to MAX_SLICED_SEARCHES A* searches take turns expanding
+// SLICE_EXPANSIONS cells each until the frame's expansion budget is spent. A long
+// search carries on over the next frames instead of stalling one or hitting the
+// MAX_EXPANSIONS cutoff.
+class PathRequestService {
+public:
+    // Higher priority is searched (and applied) first
+    static const int PRIORITY_LOW = 0;     // Background work (gathering)
+    static const int PRIORITY_NORMAL = 1;  // Chasing targets
+    static const int PRIORITY_HIGH = 2;    // Player orders
+
+    // Service used by Unit::update, nullptr = search synchronously
+    static PathRequestService* getActive() { return activeRef(); }
+    static void setActive(PathRequestService* service) { activeRef() = service; }
+
+    PathRequestService(NavigationGrid* grid, int workerCount, int expansionBudget = 8000)
+        : m_Grid(grid), m_ExpansionBudget(expansionBudget)
+    {
+        m_Snapshot = std::make_shared<const NavigationGrid>(*m_Grid);
+        m_ListenerID = m_Grid->addChangeListener([this](int, int, int, int) { m_SnapshotDirty = true; });
+
+        for (int i = 0; i < workerCount; i++) {
+            m_Workers.emplace_back([this]() { workerLoop(); });
+        }
+
+        // Zero-worker mode: arenas for the sliced searches, sized now rather than on the first frame
+        for (int i = 0; workerCount == 0 && i < MAX_SLICED_SEARCHES; i++) {
+            m_SliceArenas.emplace_back(new SearchArena());
+            m_SliceArenas.back()->begin(Pathfinder::MAP_SIZE, Pathfinder::MAP_SIZE);
+            m_Slices.emplace_back(*m_SliceArenas.back());
+        }
+    }
+
+    ~PathRequestService() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_WorkAvailable.notify_all();
+        for (auto& t : m_Workers) t.join();
+        m_Grid->removeChangeListener(m_ListenerID);
+    }
+
+    PathRequestService(const PathRequestService&) = delete;
+    PathRequestService& operator=(const PathRequestService&) = delete;
+
+    // Queue a search. Returns a ticket (never 0) to poll or cancel.
+    // With a planner, the search repairs that unit's previous chase path instead.
+    int request(const glm::vec3& start, const glm::vec3& target, int priority,
+        const std::shared_ptr<ChasePlanner>& planner = nullptr) {
+        refreshSnapshot();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        int ticket = m_NextTicket++;
+        if (m_NextTicket <= 0) m_NextTicket = 1;
+
+        m_Tickets[ticket] = Ticket();
+        m_Queue.push({ ticket, priority, m_NextSequence++, start, target, planner });
+        m_WorkAvailable.notify_one();
+        return ticket;
+    }
+
+    // READY hands the path over and retires the ticket
+    PathRequestStatus poll(int ticket, std::shared_ptr<const WaypointPath>& outPath) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto it = m_Tickets.find(ticket);
+        if (it == m_Tickets.end()) return PathRequestStatus::UNKNOWN;
+        if (!it->second.ready) return PathRequestStatus::PENDING;
+
+        outPath = it->second.path;
+        m_Tickets.erase(it);
+        return PathRequestStatus::READY;
+    }
+
+    // Forget a request (queued, running or finished). Safe to call with stale tickets.
+    void cancel(int ticket) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Tickets.erase(ticket);
+    }
+
+    // Main thread, once per rendered frame: publish at most `budget` finished searches
+    void applyResults(int budget) {
+        refreshSnapshot();
+
+        if (m_Workers.empty()) {
+            runInline(budget);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        int applied = 0;
+        while (applied < budget && !m_Finished.empty()) {
+            Job done = m_Finished.top();
+            m_Finished.pop();
+
+            auto it = m_Tickets.find(done.ticket);
+            if (it == m_Tickets.end()) continue; // Cancelled while running
+
+            it->second.ready = true;
+            applied++;
+        }
+        m_LastApplied = applied;
+    }
+
+    // --- Stats ---
+    int getWorkerCount() const { return (int)m_Workers.size(); }
+    int getLastApplied() const { return m_LastApplied; }
+    int getLastExpanded() const { return m_LastExpanded; } // Zero-worker mode only
+    size_t getPendingCount() {
+        size_t sliced = 0;
+        for (const auto& slice : m_Slices) sliced += slice.active ? 1 : 0;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Queue.size() + m_Finished.size() + sliced;
+    }
+
+private:
+    struct Job {
+        int ticket;
+        int priority;
+        uint64_t sequence;
+        glm::vec3 start, target;
+        std::shared_ptr<ChasePlanner> planner; // Optional, see request()
+    };
+
+    // Highest priority first, oldest first within a priority
+    struct JobOrder {
+        bool operator()(const Job& a, const Job& b) const {
+            if (a.priority != b.priority) return a.priority < b.priority;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    struct Ticket {
+        bool ready = false;
+        std::shared_ptr<const WaypointPath> path;
+    };
+
+    // Zero-worker mode: an A* search in progress, with its own arena
+    struct Slice {
+        explicit Slice(SearchArena& arena) : search(arena) {}
+        bool active = false;
+        Job job;
+        Pathfinder::Search search;
+    };
+
+    enum { MAX_SLICED_SEARCHES = 4, SLICE_EXPANSIONS = 256 };
+
+    static PathRequestService*& activeRef() {
+        static PathRequestService* service = nullptr;
+        return service;
+    }
+
+    NavigationGrid* m_Grid;
+    int m_ListenerID = -1;
+
+    // Grid copy the workers search on. Replaced, never modified.
+    std::shared_ptr<const NavigationGrid> m_Snapshot;
+    bool m_SnapshotDirty = false; // Main thread only (set by the grid listener)
+
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkAvailable;
+    std::priority_queue<Job, std::vector<Job>, JobOrder> m_Queue;    // Waiting for a worker
+    std::priority_queue<Job, std::vector<Job>, JobOrder> m_Finished; // Searched, waiting for applyResults
+    std::unordered_map<int, Ticket> m_Tickets;
+    std::vector<std::thread> m_Workers;
+    int m_NextTicket = 1;
+    uint64_t m_NextSequence = 0;
+    bool m_Stopping = false;
+    int m_LastApplied = 0;
+
+    // Zero-worker mode only (main thread)
+    int m_ExpansionBudget;
+    int m_LastExpanded = 0;
+    std::vector<std::unique_ptr<SearchArena>> m_SliceArenas;
+    std::vector<Slice> m_Slices;
+
+    // Swap in a fresh copy after the live grid changed (main thread)
+    void refreshSnapshot() {
+        if (!m_SnapshotDirty) return;
+        m_SnapshotDirty = false;
+
+        std::shared_ptr<const NavigationGrid> fresh = std::make_shared<const NavigationGrid>(*m_Grid);
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Snapshot = fresh;
+    }
+
+    static std::vector<glm::vec3> search(const Job& job, const NavigationGrid* grid) {
+        if (job.planner) return job.planner->findPath(job.start, job.target, grid);
+        return Pathfinder::findPath(job.start, job.target, grid);
+    }
+
+    void workerLoop() {
+        while (true) {
+            Job job;
+            std::shared_ptr<const NavigationGrid> grid;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_WorkAvailable.wait(lock, [this]() { return m_Stopping || !m_Queue.empty(); });
+                if (m_Stopping) return;
+
+                job = m_Queue.top();
+                m_Queue.pop();
+                if (m_Tickets.find(job.ticket) == m_Tickets.end()) continue; // Cancelled before it started
+                grid = m_Snapshot;
+            }
+
+            std::shared_ptr<const WaypointPath> path = std::make_shared<const WaypointPath>(search(job, grid.get()));
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            auto it = m_Tickets.find(job.ticket);
+            if (it == m_Tickets.end()) continue;
+            it->second.path = path;
+            m_Finished.push(job);
+        }
+    }
+
+    // Zero-worker mode: search on the calling (main) thread, within both budgets
+    void runInline(int budget) {
+        int applied = 0, spent = 0;
+        bool working = true;
+        while (working && applied < budget && spent < m_ExpansionBudget) {
+            working = false;
+
+            // Round robin: every search in progress gets one slice per pass
+            for (auto& slice : m_Slices) {
+                if (applied >= budget || spent >= m_ExpansionBudget) break;
+                if (!slice.active && !startSlice(slice, budget, applied, spent)) continue;
+                working = true;
+
+                if (!isWanted(slice.job.ticket)) {
+                    slice.active = false; // Cancelled mid-search
+                    continue;
+                }
+
+                int before = slice.search.getExpanded();
+                Pathfinder::Search::Status status = slice.search.step(std::min((int)SLICE_EXPANSIONS, m_ExpansionBudget - spent));
+                spent += slice.search.getExpanded() - before;
+                if (status == Pathfinder::Search::SEARCHING) continue;
+
+                // The grid may have changed since the search started: a route over a
+                // cell blocked since then is searched again
+                std::vector<glm::vec3> path = slice.search.getPath();
+                bool intact = std::all_of(path.begin(), path.end(), [this](const glm::vec3& p) {
+                    return Pathfinder::isWalkable((int)p.x, (int)p.z, m_Grid);
+                });
+                if (!intact) {
+                    if (beginSlice(slice)) continue;
+                    path.clear();
+                }
+
+                slice.active = false;
+                Pathfinder::addToTotals(slice.search.getExpanded());
+                Pathfinder::smoothPath(path, (int)slice.job.start.x, (int)slice.job.start.z, m_Grid);
+                publish(slice.job.ticket, path);
+                applied++;
+            }
+        }
+        m_LastApplied = applied;
+        m_LastExpanded = spent;
+    }
+
+    // Hand the next queued job to a free slice. Jobs that cannot be sliced (chase
+    // repairs, JPS and HPA* searches) are cheap and run to completion right here.
+    bool startSlice(Slice& slice, int budget, int& applied, int& spent) {
+        while (applied < budget && spent < m_ExpansionBudget) {
+            Job job;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (m_Queue.empty()) return false;
+                job = m_Queue.top();
+                m_Queue.pop();
+                if (m_Tickets.find(job.ticket) == m_Tickets.end()) continue;
+            }
+
+            if (job.planner || Pathfinder::getMode() != PathMode::ASTAR) {
+                publish(job.ticket, search(job, m_Grid));
+                spent += job.planner ? job.planner->getLastExpanded() : Pathfinder::lastStats().nodesExpanded;
+                applied++;
+                continue;
+            }
+
+            slice.job = job;
+            if (beginSlice(slice)) return true;
+            publish(job.ticket, std::vector<glm::vec3>()); // Nothing to search for
+            applied++;
+        }
+        return false;
+    }
+
+    // (Re)start the slice's search from its job. False if there is nothing to search for.
+    bool beginSlice(Slice& slice) {
+        int startX, startZ, targetX, targetZ;
+        slice.active = Pathfinder::resolveEndpoints(slice.job.start, slice.job.target, m_Grid, startX, startZ, targetX, targetZ);
+        if (slice.active) slice.search.begin(startX, startZ, targetX, targetZ, m_Grid);
+        return slice.active;
+    }
+
+    bool isWanted(int ticket) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Tickets.find(ticket) != m_Tickets.end();
+    }
+
+    void publish(int ticket, const std::vector<glm::vec3>& path) {
+        std::shared_ptr<const WaypointPath> shared = std::make_shared<const WaypointPath>(path);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto it = m_Tickets.find(ticket);
+        if (it == m_Tickets.end()) return;
+        it->second.path = shared;
+        it->second.ready = true;
+    }
+};
@@ -1,61 +1,155 @@
 #pragma once
 #include <vector>
 #include <glm/glm.hpp>
-#include <queue>
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
 #include "NavigationGrid.h" 
-
-struct Node {
-    int x, z;
-    float gCost;
-    float hCost;
-    Node* parent;
-    float fCost() const { return gCost + hCost; }
-};
-
-struct CompareNode {
-    bool operator()(Node* a, Node* b) {
-        return a->fCost() > b->fCost();
-    }
+#include "SearchArena.h"
+#include "JumpPointSearch.h"
+#include "HierarchicalPathfinder.h"
+#include "LandmarkHeuristic.h"
+
+// Search algorithm used by findPath (both return the same per-cell paths)
+enum class PathMode { ASTAR, JPS, HIERARCHICAL };
+
+// Counters from the most recent findPath on the calling thread
+struct PathStats {
+    PathMode mode = PathMode::ASTAR;
+    int nodesExpanded = 0;
+    bool found = false;
+    bool landmarks = false;  // A* estimate used the landmark tables
 };
 
 class Pathfinder {
+public:
     // DEFINE BORDER SIZE (Matches your rock border thickness)
     static const int BORDER_SIZE = 35;
     static const int MAP_SIZE = 512;
+    static const int MAX_EXPANSIONS = 15000;
+    static const int MAX_REDIRECT_RADIUS = 128; // How far an unreachable target may be moved
+    static const int MAX_GROUP_EXPANSIONS = 60000; // Cutoff for findPathsToArea (covers a group)
+
+    // Mode Switch
+    static PathMode getMode() { return modeRef(); }
+    static void setMode(PathMode mode) { modeRef() = mode; }
+    static const char* getModeName(PathMode mode) {
+        if (mode == PathMode::JPS) return "JPS";
+        if (mode == PathMode::HIERARCHICAL) return "HPA*";
+        return "A*";
+    }
+
+    // Cluster graph used by PathMode::HIERARCHICAL (owned by the caller)
+    static void setHierarchy(HierarchicalPathfinder* hierarchy) { hierarchyRef() = hierarchy; }
+    static HierarchicalPathfinder* getHierarchy() { return hierarchyRef(); }
+
+    // Landmark tables that sharpen the A* estimate (owned by the caller), nullptr = straight line only
+    static void setLandmarks(LandmarkHeuristic* landmarks) { landmarksRef() = landmarks; }
+    static LandmarkHeuristic* getLandmarks() { return landmarksRef(); }
+
+    static const PathStats& lastStats() { return statsRef(); }
+
+    // Running totals over every findPath on every thread, to compare modes and heuristics
+    static uint64_t getTotalSearches() { return totalsRef()[0]; }
+    static uint64_t getTotalExpanded() { return totalsRef()[1]; }
+    static void resetTotals() { totalsRef()[0] = 0; totalsRef()[1] = 0; }
+    static void addToTotals(int nodesExpanded) {
+        totalsRef()[0]++;
+        totalsRef()[1] += nodesExpanded;
+    }
+
+    // Helper: Cell is inside the playable area and not blocked
+    static bool isWalkable(int x, int z, const NavigationGrid* grid) {
+        if (x < BORDER_SIZE || x >= MAP_SIZE - BORDER_SIZE ||
+            z < BORDER_SIZE || z >= MAP_SIZE - BORDER_SIZE) return false;
+        return !grid->isBlocked(x, z);
+    }
+
+    // Helper: Straight-line distance used as the A* estimate
+    static float heuristic(int x, int z, int targetX, int targetZ) {
+        float dx = (float)(x - targetX);
+        float dz = (float)(z - targetZ);
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    // Helper: Visit every cell the straight line between two cell centres touches,
+    // in order. A line through a cell corner touches both cells beside the corner.
+    // Stops early (returning false) as soon as visit(x, z) returns false.
+    template <class Visit>
+    static bool walkLine(int x0, int z0, int x1, int z1, const Visit& visit) {
+        int nx = std::abs(x1 - x0), nz = std::abs(z1 - z0);
+        int signX = (x1 > x0) ? 1 : -1, signZ = (z1 > z0) ? 1 : -1;
+        int x = x0, z = z0;
+        if (!visit(x, z)) return false;
+
+        for (int ix = 0, iz = 0; ix < nx || iz < nz;) {
+            int decision = (1 + 2 * ix) * nz - (1 + 2 * iz) * nx;
+            if (decision == 0) {
+                if (!visit(x + signX, z) || !visit(x, z + signZ)) return false;
+                x += signX; z += signZ; ix++; iz++;
+            }
+            else if (decision < 0) {
+                x += signX; ix++;
+            }
+            else {
+                z += signZ; iz++;
+            }
+            if (!visit(x, z)) return false;
+        }
+        return true;
+    }
+
+    // Helper: A unit can walk straight from one cell to the other
+    static bool hasLineOfSight(int x0, int z0, int x1, int z1, const NavigationGrid* grid) {
+        return walkLine(x0, z0, x1, z1, [grid](int x, int z) { return isWalkable(x, z, grid); });
+    }
+
+    // Helper: String pulling. Drops every waypoint the previous kept point can see
+    // past, leaving only the corners. (originX, originZ) is where the path starts
+    // (not part of it); if that cell is blocked the first waypoint is always kept.
+    static void smoothPath(std::vector<glm::vec3>& path, int originX, int originZ, const NavigationGrid* grid) {
+        if (path.size() < 2) return;
+
+        int anchorX = originX, anchorZ = originZ;
+        size_t kept = 0;
+        for (size_t i = 0; i + 1 < path.size(); i++) {
+            int nextX = (int)path[i + 1].x, nextZ = (int)path[i + 1].z;
+
+            // One grid step is always allowed (A* moves diagonally past corners), longer ones need a clear line
+            bool oneStep = std::abs(nextX - anchorX) <= 1 && std::abs(nextZ - anchorZ) <= 1;
+            if (oneStep ? isWalkable(anchorX, anchorZ, grid) : hasLineOfSight(anchorX, anchorZ, nextX, nextZ, grid)) continue;
+
+            path[kept++] = path[i];
+            anchorX = (int)path[i].x;
+            anchorZ = (int)path[i].z;
+        }
+        path[kept++] = path.back();
+        path.resize(kept);
+    }
 
-public:
     // Helper: Find nearest walkable tile if target is blocked
     static glm::vec3 findNearestWalkable(int targetX, int targetZ, const NavigationGrid* grid, int padding = 5) {
         int radius = 1;
         int maxRadius = 20; // Increased search range
 
         while (radius < maxRadius) {
+            // Only the ring at this radius: everything inside it was rejected already
             for (int x = targetX - radius; x <= targetX + radius; x++) {
-                for (int z = targetZ - radius; z <= targetZ + radius; z++) {
+                bool edgeColumn = (x == targetX - radius || x == targetX + radius);
+                int zStep = edgeColumn ? 1 : 2 * radius;
+
+                for (int z = targetZ - radius; z <= targetZ + radius; z += zStep) {
 
                     if (x < BORDER_SIZE || x >= MAP_SIZE - BORDER_SIZE ||
                         z < BORDER_SIZE || z >= MAP_SIZE - BORDER_SIZE) continue;
 
-                    if (!grid->isBlocked(x, z)) {
-                        // Check if this spot itself has enough clearance
-                        // This prevents units from hugging the wall of a building
-                        bool spaceIsClear = true;
-                        for (int px = -padding; px <= padding; px++) {
-                            for (int pz = -padding; pz <= padding; pz++) {
-                                if (grid->isBlocked(x + px, z + pz)) {
-                                    spaceIsClear = false;
-                                    break;
-                                }
-                            }
-                            if (!spaceIsClear) break;
-                        }
-
-                        if (spaceIsClear) {
-                            return glm::vec3(x, 0.0f, z);
-                        }
+                    // Check if this spot itself has enough clearance
+                    // This prevents units from hugging the wall of a building
+                    if (grid->hasClearance(x, z, padding)) {
+                        return glm::vec3(x, 0.0f, z);
                     }
                 }
             }
@@ -64,14 +158,159 @@ public:
         return glm::vec3(-1.0f);
     }
 
-    static std::vector<glm::vec3> findPath(glm::vec3 start, glm::vec3 target, const NavigationGrid* grid)
-    {
-        std::vector<glm::vec3> path;
+    // Helper: Closest cell of a region (see NavigationGrid::getRegion) to the target
+    static glm::vec3 findNearestInRegion(int targetX, int targetZ, int region, const NavigationGrid* grid) {
+        int bestX = -1, bestZ = -1;
+        float bestDist = 0.0f;
+
+        for (int radius = 1; radius < MAX_REDIRECT_RADIUS; radius++) {
+            // Every cell of this ring is at least `radius` away
+            if (bestX != -1 && (float)radius > bestDist) break;
+
+            for (int x = targetX - radius; x <= targetX + radius; x++) {
+                bool edgeColumn = (x == targetX - radius || x == targetX + radius);
+                int zStep = edgeColumn ? 1 : 2 * radius;
+
+                for (int z = targetZ - radius; z <= targetZ + radius; z += zStep) {
+                    if (x < BORDER_SIZE || x >= MAP_SIZE - BORDER_SIZE ||
+                        z < BORDER_SIZE || z >= MAP_SIZE - BORDER_SIZE) continue;
+                    if (grid->getRegion(x, z) != region) continue;
+
+                    float dist = heuristic(x, z, targetX, targetZ);
+                    if (bestX == -1 || dist < bestDist) {
+                        bestX = x;
+                        bestZ = z;
+                        bestDist = dist;
+                    }
+                }
+            }
+        }
+        if (bestX == -1) return glm::vec3(-1.0f);
+        return glm::vec3(bestX, 0.0f, bestZ);
+    }
+
+    // Plain 8-connected A* that can stop after any number of expansions and carry
+    // on later from where it was. Stops next to the target (within one cell).
+    // All open/closed state lives in the arena, which must not run another search
+    // until this one is done; the grid must not change in between either (or the
+    // caller has to check the finished path against what changed).
+    class Search {
+    public:
+        enum Status { SEARCHING, FOUND, FAILED };
+
+        explicit Search(SearchArena& arena) : m_Arena(&arena) {}
+
+        void begin(int startX, int startZ, int targetX, int targetZ, const NavigationGrid* grid) {
+            m_Grid = grid;
+            m_TargetX = targetX;
+            m_TargetZ = targetZ;
+            m_Expanded = 0;
+            m_FinalIdx = -1;
+            m_Status = SEARCHING;
+
+            // Estimate: the straight line, or the landmark bound where that is larger
+            LandmarkHeuristic* alt = getLandmarks();
+            m_Landmarks = alt ? LandmarkHeuristic::Estimate(alt->getTable(MAP_SIZE, MAP_SIZE), targetZ * MAP_SIZE + targetX)
+                              : LandmarkHeuristic::Estimate();
+
+            // Nodes live in a reusable arena indexed by cell, so a search allocates
+            // nothing and starts without clearing a 512x512 closed set.
+            m_Arena->begin(MAP_SIZE, MAP_SIZE);
+            m_Arena->pushOrDecrease(startZ * MAP_SIZE + startX, 0.0f, estimate(startX, startZ), -1);
+        }
+
+        // Expand at most `budget` more cells
+        Status step(int budget) {
+            SearchArena& arena = *m_Arena;
+
+            for (int spent = 0; m_Status == SEARCHING && spent < budget; spent++) {
+                if (arena.openEmpty()) {
+                    m_Status = FAILED;
+                    break;
+                }
+
+                int currentIdx = arena.popMin();
+                arena.close(currentIdx);
+                m_Expanded++;
+
+                int cx = currentIdx % MAP_SIZE;
+                int cz = currentIdx / MAP_SIZE;
+
+                // Found Goal?
+                if (abs(cx - m_TargetX) <= 1 && abs(cz - m_TargetZ) <= 1) {
+                    m_FinalIdx = currentIdx;
+                    m_Status = FOUND;
+                    break;
+                }
+
+                float currentG = arena.g(currentIdx);
 
-        int startX = (int)start.x;
-        int startZ = (int)start.z;
-        int targetX = (int)target.x;
-        int targetZ = (int)target.z;
+                // Neighbor Loop
+                for (int dx = -1; dx <= 1; dx++) {
+                    for (int dz = -1; dz <= 1; dz++) {
+                        if (dx == 0 && dz == 0) continue;
+
+                        int nx = cx + dx;
+                        int nz = cz + dz;
+
+                        // Border + Obstacle Check
+                        if (!isWalkable(nx, nz, m_Grid)) continue;
+
+                        int neighborIdx = nz * MAP_SIZE + nx;
+                        if (arena.isClosed(neighborIdx)) continue;
+
+                        float newGCost = currentG + ((dx != 0 && dz != 0) ? 1.414f : 1.0f);
+                        arena.pushOrDecrease(neighborIdx, newGCost, estimate(nx, nz), currentIdx);
+                    }
+                }
+            }
+            return m_Status;
+        }
+
+        Status getStatus() const { return m_Status; }
+        int getExpanded() const { return m_Expanded; }
+        bool usedLandmarks() const { return m_Landmarks.valid(); }
+
+        // Per-cell route once FOUND (start excluded, goal included), empty otherwise
+        std::vector<glm::vec3> getPath() const {
+            std::vector<glm::vec3> path;
+            if (m_Status != FOUND) return path;
+
+            for (int idx = m_FinalIdx; idx != -1; idx = m_Arena->parent(idx)) {
+                path.push_back(glm::vec3(idx % MAP_SIZE, 0.0f, idx / MAP_SIZE));
+            }
+            std::reverse(path.begin(), path.end());
+            path.erase(path.begin());
+            return path;
+        }
+
+    private:
+        SearchArena* m_Arena;
+        const NavigationGrid* m_Grid = nullptr;
+        LandmarkHeuristic::Estimate m_Landmarks;
+        int m_TargetX = 0, m_TargetZ = 0;
+        int m_Expanded = 0;
+        int m_FinalIdx = -1;
+        Status m_Status = FAILED;
+
+        float estimate(int x, int z) const {
+            float h = heuristic(x, z, m_TargetX, m_TargetZ);
+            if (m_Landmarks.valid()) h = std::max(h, m_Landmarks.at(z * MAP_SIZE + x));
+            return h;
+        }
+    };
+
+    // Turn a unit position and an order target into the cells a search runs between:
+    // the target is clamped to the playable area, both ends are moved off rocks, and
+    // a target the start cannot reach is swapped for the closest cell it can.
+    // Returns false if there is nothing to search for.
+    static bool resolveEndpoints(glm::vec3 start, glm::vec3 target, const NavigationGrid* grid,
+        int& startX, int& startZ, int& targetX, int& targetZ)
+    {
+        startX = (int)start.x;
+        startZ = (int)start.z;
+        targetX = (int)target.x;
+        targetZ = (int)target.z;
 
 
         // CLAMP TARGET TO SAFE ZONE
@@ -92,7 +331,7 @@ public:
                 startZ = (int)freeStart.z;
             }
             else {
-                return path; // Give up
+                return false; // Give up
             }
         }
 
@@ -102,96 +341,216 @@ public:
             // std::cout << "TARGET BLOCKED! Searching nearby..." << std::endl;
             glm::vec3 newTarget = findNearestWalkable(targetX, targetZ, grid);
             if (newTarget.x == -1.0f) {
-                return path;
+                return false;
             }
             targetX = (int)newTarget.x;
             targetZ = (int)newTarget.z;
         }
 
-        // Standard A* Setup
-        std::priority_queue<Node*, std::vector<Node*>, CompareNode> openSet;
+        // 4. CHECK REACHABILITY
+        // A target walled off from the start would be searched until the cutoff and
+        // still fail: head for the closest cell the start can actually reach instead
+        int startRegion = grid->getRegion(startX, startZ);
+        int targetRegion = grid->getRegion(targetX, targetZ);
+        if (startRegion != 0 && targetRegion != 0 && startRegion != targetRegion) {
+            glm::vec3 reachable = findNearestInRegion(targetX, targetZ, startRegion, grid);
+            if (reachable.x == -1.0f) {
+                return false;
+            }
+            targetX = (int)reachable.x;
+            targetZ = (int)reachable.z;
+        }
 
-        // Use static to avoid reallocating memory every click
-        static std::vector<bool> closedSet(MAP_SIZE * MAP_SIZE, false);
-        // fill is safe enough for 512x512
-        std::fill(closedSet.begin(), closedSet.end(), false);
+        // Arena cells only cover the map
+        return startX >= 0 && startX < MAP_SIZE && startZ >= 0 && startZ < MAP_SIZE;
+    }
 
-        // Track allocated nodes to delete them later
-        std::vector<Node*> allNodes;
+    // Returns the corner cells of the route (start excluded, goal included), empty if none
+    static std::vector<glm::vec3> findPath(glm::vec3 start, glm::vec3 target, const NavigationGrid* grid)
+    {
+        std::vector<glm::vec3> path;
 
-        Node* startNode = new Node{ startX, startZ, 0.0f, 0.0f, nullptr };
-        startNode->hCost = glm::distance(glm::vec2(startX, startZ), glm::vec2(targetX, targetZ));
-        openSet.push(startNode);
-        allNodes.push_back(startNode);
+        int startX, startZ, targetX, targetZ;
+        if (!resolveEndpoints(start, target, grid, startX, startZ, targetX, targetZ)) return path;
 
-        Node* finalNode = nullptr;
-        int nodesExplored = 0;
+        PathStats& stats = statsRef();
+        stats.mode = getMode();
+        stats.landmarks = false;
 
-        while (!openSet.empty()) {
-            Node* current = openSet.top();
-            openSet.pop();
-            nodesExplored++;
+        // The hierarchy only describes the grid it was built on
+        HierarchicalPathfinder* hierarchy = getHierarchy();
+        if (stats.mode == PathMode::HIERARCHICAL && (!hierarchy || hierarchy->getGrid() != grid)) {
+            stats.mode = PathMode::ASTAR;
+        }
 
-            int currentIdx = current->z * MAP_SIZE + current->x;
-            if (currentIdx < 0 || currentIdx >= closedSet.size()) continue;
-            if (closedSet[currentIdx]) continue;
-            closedSet[currentIdx] = true;
+        if (stats.mode == PathMode::HIERARCHICAL) {
+            path = hierarchy->findPath(startX, startZ, targetX, targetZ, stats.nodesExpanded);
+        }
+        else if (stats.mode == PathMode::JPS) {
+            auto walkable = [grid](int x, int z) { return isWalkable(x, z, grid); };
+            path = JumpPointSearch::findPath(startX, startZ, targetX, targetZ, MAP_SIZE, MAP_SIZE,
+                walkable, MAX_EXPANSIONS, stats.nodesExpanded);
+        }
+        else {
+            path = searchAStar(startX, startZ, targetX, targetZ, grid, stats.nodesExpanded, stats.landmarks);
+        }
+        stats.found = !path.empty();
+        addToTotals(stats.nodesExpanded);
 
-            // Found Goal?
-            if (abs(current->x - targetX) <= 1 && abs(current->z - targetZ) <= 1) {
-                finalNode = current;
-                break;
-            }
+        // SMOOTH: corners only (from where the unit really is, the start may have moved off a rock)
+        smoothPath(path, (int)start.x, (int)start.z, grid);
 
-            // Safety Cutoff
-            if (nodesExplored > 15000) {
-                // std::cout << "Pathfinding timeout." << std::endl;
-                break;
+        return path;
+    }
+
+    // Group order: one search for many units heading to the same place.
+    // Grows a shortest-path tree backwards from every walkable cell within `radius`
+    // of `goal` until each unit's start cell is reached, then reads every route off
+    // the tree, so N units cost about one search.
+    // Returns one path per start (corner cells, start excluded). A start that is
+    // already inside the area, cannot reach it, or was not reached before the
+    // cutoff gets an empty path.
+    static std::vector<std::vector<glm::vec3>> findPathsToArea(const std::vector<glm::vec3>& starts,
+        glm::vec3 goal, float radius, const NavigationGrid* grid)
+    {
+        std::vector<std::vector<glm::vec3>> paths(starts.size());
+        PathStats& stats = statsRef();
+        stats.mode = PathMode::ASTAR;
+        stats.nodesExpanded = 0;
+        stats.landmarks = false;
+        stats.found = false;
+
+        // 1. GOAL AREA: walkable cells within the radius, and the regions they touch
+        int reach = (int)radius;
+        std::vector<int> goalCells;
+        std::vector<int> goalRegions;
+        for (int z = (int)goal.z - reach; z <= (int)goal.z + reach; z++) {
+            for (int x = (int)goal.x - reach; x <= (int)goal.x + reach; x++) {
+                if (!isWalkable(x, z, grid) || heuristic(x, z, (int)goal.x, (int)goal.z) > radius) continue;
+                goalCells.push_back(z * MAP_SIZE + x);
+                int region = grid->getRegion(x, z);
+                if (std::find(goalRegions.begin(), goalRegions.end(), region) == goalRegions.end()) goalRegions.push_back(region);
+            }
+        }
+        if (goalCells.empty()) return paths;
+
+        // 2. STARTS: moved off rocks like in findPath, skipped if they cannot get there
+        std::vector<std::pair<int, int>> waiting; // (cell, index into starts), sorted by cell
+        int minX = MAP_SIZE, minZ = MAP_SIZE, maxX = -1, maxZ = -1;
+        for (size_t i = 0; i < starts.size(); i++) {
+            int startX = (int)starts[i].x, startZ = (int)starts[i].z;
+            if (grid->isBlocked(startX, startZ)) {
+                glm::vec3 freeStart = findNearestWalkable(startX, startZ, grid);
+                if (freeStart.x == -1.0f) continue;
+                startX = (int)freeStart.x;
+                startZ = (int)freeStart.z;
             }
+            if (!isWalkable(startX, startZ, grid)) continue;
+            if (heuristic(startX, startZ, (int)goal.x, (int)goal.z) <= radius) continue;
+            int region = grid->getRegion(startX, startZ);
+            if (std::find(goalRegions.begin(), goalRegions.end(), region) == goalRegions.end()) continue;
+
+            waiting.push_back(std::make_pair(startZ * MAP_SIZE + startX, (int)i));
+            minX = std::min(minX, startX); maxX = std::max(maxX, startX);
+            minZ = std::min(minZ, startZ); maxZ = std::max(maxZ, startZ);
+        }
+        if (waiting.empty()) return paths;
+        std::sort(waiting.begin(), waiting.end());
+
+        // 3. SEARCH from the goal area. The estimate is the distance to the box around
+        // the starts, which never overestimates the way to the nearest start still waiting.
+        auto toStarts = [&](int x, int z) {
+            int dx = std::max(0, std::max(minX - x, x - maxX));
+            int dz = std::max(0, std::max(minZ - z, z - maxZ));
+            return std::sqrt((float)(dx * dx + dz * dz));
+        };
+
+        SearchArena& arena = SearchArena::local();
+        arena.begin(MAP_SIZE, MAP_SIZE);
+        for (int idx : goalCells) arena.pushOrDecrease(idx, 0.0f, toStarts(idx % MAP_SIZE, idx / MAP_SIZE), -1);
+
+        int remaining = (int)waiting.size();
+        while (remaining > 0 && !arena.openEmpty() && stats.nodesExpanded < MAX_GROUP_EXPANSIONS) {
+            int currentIdx = arena.popMin();
+            arena.close(currentIdx);
+            stats.nodesExpanded++;
+
+            // Settled a start cell: its route to the goal is final
+            auto hit = std::lower_bound(waiting.begin(), waiting.end(), std::make_pair(currentIdx, -1));
+            for (; hit != waiting.end() && hit->first == currentIdx; ++hit) remaining--;
+
+            int cx = currentIdx % MAP_SIZE;
+            int cz = currentIdx / MAP_SIZE;
+            float currentG = arena.g(currentIdx);
 
-            // Neighbor Loop
             for (int dx = -1; dx <= 1; dx++) {
                 for (int dz = -1; dz <= 1; dz++) {
                     if (dx == 0 && dz == 0) continue;
 
-                    int nx = current->x + dx;
-                    int nz = current->z + dz;
-
-                    // STRICT BORDER CHECK
-                    // Ignore any neighbor inside the rock border
-                    if (nx < BORDER_SIZE || nx >= MAP_SIZE - BORDER_SIZE ||
-                        nz < BORDER_SIZE || nz >= MAP_SIZE - BORDER_SIZE) continue;
-
-                    // Standard Obstacle Check
-                    if (grid->isBlocked(nx, nz)) continue;
+                    int nx = cx + dx;
+                    int nz = cz + dz;
+                    if (!isWalkable(nx, nz, grid)) continue;
 
                     int neighborIdx = nz * MAP_SIZE + nx;
-                    if (closedSet[neighborIdx]) continue;
-
-                    float newGCost = current->gCost + ((dx != 0 && dz != 0) ? 1.414f : 1.0f);
-
-                    Node* neighbor = new Node{ nx, nz, newGCost, 0.0f, current };
-                    neighbor->hCost = glm::distance(glm::vec2(nx, nz), glm::vec2(targetX, targetZ));
-                    openSet.push(neighbor);
-                    allNodes.push_back(neighbor);
+                    if (arena.isClosed(neighborIdx)) continue;
+                    arena.pushOrDecrease(neighborIdx, currentG + ((dx != 0 && dz != 0) ? 1.414f : 1.0f), toStarts(nx, nz), currentIdx);
                 }
             }
         }
+        addToTotals(stats.nodesExpanded);
+
+        // 4. ROUTES: parents lead from each settled start to the goal area
+        for (const auto& w : waiting) {
+            if (!arena.isClosed(w.first)) continue;
 
-        // Reconstruct Path
-        if (finalNode) {
-            Node* curr = finalNode;
-            while (curr != nullptr) {
-                path.push_back(glm::vec3(curr->x, 0.0f, curr->z));
-                curr = curr->parent;
+            std::vector<glm::vec3>& path = paths[w.second];
+            for (int idx = arena.parent(w.first); idx != -1; idx = arena.parent(idx)) {
+                path.push_back(glm::vec3(idx % MAP_SIZE, 0.0f, idx / MAP_SIZE));
             }
-            std::reverse(path.begin(), path.end());
-            if (!path.empty()) path.erase(path.begin());
+            smoothPath(path, (int)starts[w.second].x, (int)starts[w.second].z, grid);
+            stats.found = true;
         }
+        return paths;
+    }
 
-        // Cleanup Memory
-        for (Node* n : allNodes) delete n;
+private:
+    // Atomic: path workers read these while the main thread may toggle them
+    static std::atomic<PathMode>& modeRef() {
+        static std::atomic<PathMode> mode(PathMode::ASTAR);
+        return mode;
+    }
 
-        return path;
+    static std::atomic<HierarchicalPathfinder*>& hierarchyRef() {
+        static std::atomic<HierarchicalPathfinder*> hierarchy(nullptr);
+        return hierarchy;
+    }
+
+    static std::atomic<LandmarkHeuristic*>& landmarksRef() {
+        static std::atomic<LandmarkHeuristic*> landmarks(nullptr);
+        return landmarks;
+    }
+
+    static PathStats& statsRef() {
+        thread_local PathStats stats;
+        return stats;
+    }
+
+    // [0] searches, [1] expanded cells
+    static std::atomic<uint64_t>* totalsRef() {
+        static std::atomic<uint64_t> totals[2] = { {0}, {0} };
+        return totals;
+    }
+
+    // Plain 8-connected A*, cut off after MAX_EXPANSIONS
+    static std::vector<glm::vec3> searchAStar(int startX, int startZ, int targetX, int targetZ,
+        const NavigationGrid* grid, int& nodesExplored, bool& usedLandmarks)
+    {
+        Search search(SearchArena::local());
+        search.begin(startX, startZ, targetX, targetZ, grid);
+        search.step(MAX_EXPANSIONS + 1);
+
+        nodesExplored = search.getExpanded();
+        usedLandmarks = search.usedLandmarks();
+        return search.getPath();
     }
 };
\ No newline at end of file
@@ -0,0 +1,137 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// Reusable storage for grid searches (A* and friends).
+// Every array is indexed by cell (z * width + x). Instead of clearing the arrays
+// before each search we bump a generation counter: a cell only counts as "seen"
+// or "closed" if its stamp matches the current generation.
+// The open list is an indexed binary heap, so improving a cell's cost is a
+// decrease-key instead of pushing a duplicate entry.
+class SearchArena {
+public:
+    // One arena per thread, reused by every search that thread runs
+    static SearchArena& local() {
+        thread_local SearchArena arena;
+        return arena;
+    }
+
+    // Prepare for a new search on a grid of the given size
+    void begin(int width, int height) {
+        size_t cells = (size_t)width * (size_t)height;
+        if (m_G.size() != cells) {
+            m_G.assign(cells, 0.0f);
+            m_F.assign(cells, 0.0f);
+            m_Parent.assign(cells, -1);
+            m_HeapPos.assign(cells, -1);
+            m_SeenGen.assign(cells, 0);
+            m_ClosedGen.assign(cells, 0);
+            m_Generation = 0;
+        }
+
+        m_Generation++;
+        if (m_Generation == 0) {
+            // Stamp counter wrapped: old stamps could collide, wipe them once
+            std::fill(m_SeenGen.begin(), m_SeenGen.end(), 0u);
+            std::fill(m_ClosedGen.begin(), m_ClosedGen.end(), 0u);
+            m_Generation = 1;
+        }
+        m_Heap.clear();
+    }
+
+    // --- Per-cell state ---
+    bool isSeen(int idx) const { return m_SeenGen[idx] == m_Generation; }
+    bool isClosed(int idx) const { return m_ClosedGen[idx] == m_Generation; }
+    void close(int idx) { m_ClosedGen[idx] = m_Generation; }
+
+    float g(int idx) const { return m_G[idx]; }
+    int parent(int idx) const { return m_Parent[idx]; }
+
+    // Insert a cell into the open list, or lower its cost if the new route is cheaper.
+    // Returns false if the cell is closed or the new cost is not an improvement.
+    bool pushOrDecrease(int idx, float g, float h, int parent) {
+        if (isSeen(idx)) {
+            if (isClosed(idx) || g >= m_G[idx]) return false;
+            float f = g + h;
+            m_G[idx] = g;
+            m_F[idx] = f;
+            m_Parent[idx] = parent;
+            siftUp(m_HeapPos[idx]);
+            return true;
+        }
+
+        m_SeenGen[idx] = m_Generation;
+        m_G[idx] = g;
+        m_F[idx] = g + h;
+        m_Parent[idx] = parent;
+        m_HeapPos[idx] = (int)m_Heap.size();
+        m_Heap.push_back(idx);
+        siftUp(m_HeapPos[idx]);
+        return true;
+    }
+
+    bool openEmpty() const { return m_Heap.empty(); }
+    size_t openSize() const { return m_Heap.size(); }
+
+    // Remove and return the open cell with the lowest f cost
+    int popMin() {
+        int top = m_Heap[0];
+        int last = m_Heap.back();
+        m_Heap.pop_back();
+        m_HeapPos[top] = -1;
+        if (!m_Heap.empty()) {
+            m_Heap[0] = last;
+            m_HeapPos[last] = 0;
+            siftDown(0);
+        }
+        return top;
+    }
+
+private:
+    std::vector<float> m_G;
+    std::vector<float> m_F;
+    std::vector<int> m_Parent;
+    std::vector<int> m_HeapPos;      // Position inside m_Heap, -1 if not queued
+    std::vector<uint32_t> m_SeenGen;
+    std::vector<uint32_t> m_ClosedGen;
+    uint32_t m_Generation = 0;
+
+    std::vector<int> m_Heap;         // Cell indices ordered by f cost
+
+    // Lower f first; on ties prefer the deeper node (higher g), it is closer to the goal
+    bool less(int a, int b) const {
+        if (m_F[a] != m_F[b]) return m_F[a] < m_F[b];
+        return m_G[a] > m_G[b];
+    }
+
+    void siftUp(int pos) {
+        int idx = m_Heap[pos];
+        while (pos > 0) {
+            int parentPos = (pos - 1) / 2;
+            int parentIdx = m_Heap[parentPos];
+            if (!less(idx, parentIdx)) break;
+            m_Heap[pos] = parentIdx;
+            m_HeapPos[parentIdx] = pos;
+            pos = parentPos;
+        }
+        m_Heap[pos] = idx;
+        m_HeapPos[idx] = pos;
+    }
+
+    void siftDown(int pos) {
+        int count = (int)m_Heap.size();
+        int idx = m_Heap[pos];
+        while (true) {
+            int child = pos * 2 + 1;
+            if (child >= count) break;
+            if (child + 1 < count && less(m_Heap[child + 1], m_Heap[child])) child++;
+            if (!less(m_Heap[child], idx)) break;
+            m_Heap[pos] = m_Heap[child];
+            m_HeapPos[m_Heap[pos]] = pos;
+            pos = child;
+        }
+        m_Heap[pos] = idx;
+        m_HeapPos[idx] = pos;
+    }
+};
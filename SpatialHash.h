@@ -0,0 +1,248 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Unit.h"
+
+// Uniform grid over the map for unit neighbour queries.
+// rebuild() bins every unit by position once per tick with a counting sort: count
+// per cell, prefix sums, scatter. That is O(N), needs no per-cell lists, and leaves
+// each cell's units next to each other in one array. A query then only visits the
+// cells its circle overlaps, so the neighbour sets are exact and the cost depends on
+// the local crowd, not on the total unit count.
+// Queries see the positions as of the last rebuild, so every unit updated in the
+// same tick sees the same neighbours whatever the update order.
+class SpatialHash {
+public:
+    // About two unit spacings: in a crowd the closest few units are in the first ring of cells
+    static constexpr float CELL_SIZE = 4.0f;
+    enum { BLOCK_CELLS = 8 };        // Cells per side of a block in the team presence map
+
+    struct Entry {
+        Unit* unit;
+        glm::vec3 position;
+        int team;
+    };
+
+    struct Neighbor {
+        const Entry* entry;
+        float dist2;                 // Squared distance on the XZ plane
+    };
+
+    explicit SpatialHash(float worldSize)
+        : m_Side(std::max(1, (int)std::ceil(worldSize / CELL_SIZE))),
+          m_BlockSide((m_Side + BLOCK_CELLS - 1) / BLOCK_CELLS) {
+        m_CellStart.assign((size_t)m_Side * m_Side + 1, 0);
+        m_BlockTeams.assign((size_t)m_BlockSide * m_BlockSide, 0);
+    }
+
+    // Bin every unit, or only those of one team (-1 = all)
+    void rebuild(const UnitStore& units, int team = -1) {
+        // 1. COUNT (and note which teams are in each block)
+        std::fill(m_CellStart.begin(), m_CellStart.end(), 0);
+        std::fill(m_BlockTeams.begin(), m_BlockTeams.end(), 0);
+        m_CellOf.resize(units.size());
+        size_t count = 0;
+        for (size_t i = 0; i < units.size(); i++) {
+            if (team != -1 && units.team[i] != team) {
+                m_CellOf[i] = -1;
+                continue;
+            }
+            count++;
+            int cx = clampCell(units.position[i].x), cz = clampCell(units.position[i].z);
+            m_CellOf[i] = cz * m_Side + cx;
+            m_CellStart[m_CellOf[i] + 1]++;
+            m_BlockTeams[(cz / BLOCK_CELLS) * m_BlockSide + cx / BLOCK_CELLS] |= teamBit(units.team[i]);
+        }
+
+        // 2. PREFIX SUM: cell c holds entries [m_CellStart[c], m_CellStart[c + 1])
+        for (size_t c = 1; c < m_CellStart.size(); c++) m_CellStart[c] += m_CellStart[c - 1];
+
+        // 3. SCATTER (in slot order inside each cell)
+        m_Entries.resize(count);
+        m_Fill.assign(m_CellStart.begin(), m_CellStart.end() - 1);
+        for (size_t i = 0; i < units.size(); i++) {
+            if (m_CellOf[i] == -1) continue;
+            Entry& e = m_Entries[m_Fill[m_CellOf[i]]++];
+            e.unit = units.owner[i];
+            e.position = units.position[i];
+            e.team = units.team[i];
+        }
+    }
+
+    // Call fn(entry) for every unit within radius of pos (on the XZ plane)
+    template <class Fn>
+    void forEachInRadius(const glm::vec3& pos, float radius, Fn fn) const {
+        int x0, z0, x1, z1;
+        cellRange(pos, radius, x0, z0, x1, z1);
+        float r2 = radius * radius;
+        for (int cz = z0; cz <= z1; cz++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                int c = cz * m_Side + cx;
+                for (int i = m_CellStart[c]; i < m_CellStart[c + 1]; i++) {
+                    const Entry& e = m_Entries[i];
+                    float dx = e.position.x - pos.x, dz = e.position.z - pos.z;
+                    if (dx * dx + dz * dz <= r2) fn(e);
+                }
+            }
+        }
+    }
+
+    // Units within radius, optionally only those of one team (-1 = any)
+    void queryRadius(const glm::vec3& pos, float radius, std::vector<Unit*>& out, int team = -1) const {
+        out.clear();
+        forEachInRadius(pos, radius, [&](const Entry& e) {
+            if (team == -1 || e.team == team) out.push_back(e.unit);
+        });
+    }
+
+    // Up to k units closest to pos within radius, nearest first, skipping `self`.
+    // Visits rings of cells outwards and stops once the next ring cannot hold
+    // anything closer than the k-th unit found, so in a dense crowd it looks at a
+    // handful of cells instead of everything in the radius.
+    // Uses only `out` as scratch, so update threads can query at the same time.
+    void kNearest(const glm::vec3& pos, int k, float radius, std::vector<Neighbor>& out, const Unit* self = nullptr) const {
+        out.clear();
+        if (k <= 0) return;
+
+        int px = clampCell(pos.x), pz = clampCell(pos.z);
+        int x0, z0, x1, z1;
+        cellRange(pos, radius, x0, z0, x1, z1);
+        int rings = std::max(std::max(px - x0, x1 - px), std::max(pz - z0, z1 - pz));
+
+        // Distance from pos to the edge of its own cell: ring r is at least this plus (r - 1) cells away
+        float edge = std::min(std::min(pos.x - px * CELL_SIZE, (px + 1) * CELL_SIZE - pos.x),
+                              std::min(pos.z - pz * CELL_SIZE, (pz + 1) * CELL_SIZE - pos.z));
+        edge = std::max(edge, 0.0f);
+        float r2 = radius * radius;
+
+        auto visit = [&](int cx, int cz) {
+            if (cx < x0 || cx > x1 || cz < z0 || cz > z1) return;
+            int c = cz * m_Side + cx;
+            for (int i = m_CellStart[c]; i < m_CellStart[c + 1]; i++) {
+                const Entry& e = m_Entries[i];
+                if (e.unit == self) continue;
+                float d2 = distance2(e.position, pos);
+                if (d2 > r2 || ((int)out.size() == k && d2 >= out.back().dist2)) continue;
+
+                // Insertion into the short sorted list
+                if ((int)out.size() < k) out.push_back(Neighbor());
+                int j = (int)out.size() - 1;
+                for (; j > 0 && out[j - 1].dist2 > d2; j--) out[j] = out[j - 1];
+                out[j].entry = &e;
+                out[j].dist2 = d2;
+            }
+        };
+
+        visit(px, pz);
+        for (int r = 1; r <= rings; r++) {
+            if ((int)out.size() == k) {
+                float ringDist = edge + (r - 1) * CELL_SIZE;
+                if (ringDist * ringDist > out.back().dist2) break;
+            }
+            // Top and bottom rows of the ring, then the two side columns between them
+            for (int cx = px - r; cx <= px + r; cx++) {
+                visit(cx, pz - r);
+                visit(cx, pz + r);
+            }
+            for (int cz = pz - r + 1; cz <= pz + r - 1; cz++) {
+                visit(px - r, cz);
+                visit(px + r, cz);
+            }
+        }
+    }
+
+    // Any unit of another team nearby: in our block of BLOCK_CELLS x BLOCK_CELLS cells or
+    // one of the 8 around it, so certainly anyone within one block width and perhaps
+    // some up to two away. Nine lookups, for coarse questions asked of many units.
+    bool isEnemyNear(const glm::vec3& pos, int team) const {
+        int bx = clampCell(pos.x) / BLOCK_CELLS, bz = clampCell(pos.z) / BLOCK_CELLS;
+        uint32_t others = ~teamBit(team);
+        for (int z = std::max(bz - 1, 0); z <= std::min(bz + 1, m_BlockSide - 1); z++) {
+            for (int x = std::max(bx - 1, 0); x <= std::min(bx + 1, m_BlockSide - 1); x++) {
+                if (m_BlockTeams[z * m_BlockSide + x] & others) return true;
+            }
+        }
+        return false;
+    }
+
+    // Closest unit within radius, nullptr if none
+    Unit* nearest(const glm::vec3& pos, float radius, int team = -1) const {
+        Unit* best = nullptr;
+        float bestD2 = radius * radius;
+        forEachInRadius(pos, radius, [&](const Entry& e) {
+            if (team != -1 && e.team != team) return;
+            float d2 = distance2(e.position, pos);
+            if (d2 < bestD2 || (d2 == bestD2 && !best)) { bestD2 = d2; best = e.unit; }
+        });
+        return best;
+    }
+
+    size_t size() const { return m_Entries.size(); }
+
+private:
+    int m_Side;                      // Cells per map side
+    int m_BlockSide;                 // Blocks per map side
+    std::vector<uint32_t> m_BlockTeams; // Bit per team present in each block
+    std::vector<int> m_CellStart;    // m_Side^2 + 1 offsets into m_Entries
+    std::vector<Entry> m_Entries;    // Units sorted by cell
+    std::vector<int> m_CellOf;       // Scratch for rebuild: cell of each unit
+    std::vector<int> m_Fill;         // Scratch for rebuild: next free entry per cell
+
+    static float distance2(const glm::vec3& a, const glm::vec3& b) {
+        float dx = a.x - b.x, dz = a.z - b.z;
+        return dx * dx + dz * dz;
+    }
+
+    static uint32_t teamBit(int team) { return 1u << (team & 31); }
+
+    int clampCell(float v) const {
+        return std::max(0, std::min((int)std::floor(v / CELL_SIZE), m_Side - 1));
+    }
+
+    void cellRange(const glm::vec3& pos, float radius, int& x0, int& z0, int& x1, int& z1) const {
+        x0 = clampCell(pos.x - radius);
+        z0 = clampCell(pos.z - radius);
+        x1 = clampCell(pos.x + radius);
+        z1 = clampCell(pos.z + radius);
+    }
+};
+
+// The units split by team, one SpatialHash each, so a search for enemies never wades
+// through friendly units (in a big fight, half of everyone nearby)
+class TeamSpatialIndex {
+public:
+    explicit TeamSpatialIndex(float worldSize) : m_WorldSize(worldSize) {}
+
+    void rebuild(const UnitStore& units) {
+        int teams = 0;
+        for (int t : units.team) teams = std::max(teams, t + 1);
+        while ((int)m_Teams.size() < teams) m_Teams.emplace_back(m_WorldSize);
+        for (int t = 0; t < (int)m_Teams.size(); t++) m_Teams[t].rebuild(units, t);
+    }
+
+    // Up to k units of teams other than `team` within radius, nearest first.
+    // Uses only `out` (and a per-thread scratch list), so update threads can ask at once.
+    void nearestHostiles(const glm::vec3& pos, int k, float radius, int team, std::vector<SpatialHash::Neighbor>& out) const {
+        static thread_local std::vector<SpatialHash::Neighbor> found;
+        out.clear();
+        for (int t = 0; t < (int)m_Teams.size(); t++) {
+            if (t == team) continue;
+            m_Teams[t].kNearest(pos, k, radius, found);
+            out.insert(out.end(), found.begin(), found.end());
+        }
+        // At most k per hostile team, so this sort is tiny
+        std::sort(out.begin(), out.end(), [](const SpatialHash::Neighbor& a, const SpatialHash::Neighbor& b) { return a.dist2 < b.dist2; });
+        if ((int)out.size() > k) out.resize(k);
+    }
+
+    const SpatialHash* getTeam(int team) const {
+        return (team >= 0 && team < (int)m_Teams.size()) ? &m_Teams[team] : nullptr;
+    }
+
+private:
+    float m_WorldSize;
+    std::vector<SpatialHash> m_Teams;
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "UnitStore.h"
+
+// SSE2 is part of every x64 target; elsewhere (or with this removed) the scalar path runs
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SIMD_STEERING
+#include <emmintrin.h>
+#endif
+
+// Movement phase of every unit at once, after each unit's update has summed its
+// steering forces into UnitStore::steering. Works straight on the store's arrays,
+// four units per SSE step: three loads pull four packed vec3s apart into x, y and z
+// lanes, the lanes run the same math as the scalar version, and three stores put
+// them back. Anything that needs the grid or the terrain (wall sliding, height)
+// stays per unit in Unit::integrateMovement, between the two batch passes.
+class SteeringIntegrator {
+#ifdef USE_SIMD_STEERING
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "load4/store4 need tightly packed vec3s");
+#endif
+public:
+    static constexpr float MAX_SPEED = 10.0f;
+    static constexpr float MOVING_DAMPING = 0.95f;  // Velocity kept per tick while MOVING
+    static constexpr float IDLE_DAMPING = 0.5f;     // ... and in every other state
+    static constexpr float STOP_SPEED = 0.1f;       // Slower than this and we stand still
+    static constexpr float MAP_SIZE = 512.0f;
+    static constexpr float BORDER_SIZE = 30.0f;     // Thickness of the border rocks (safety margin)
+
+    // Slots [begin, end): apply steering, clamp speed, damp, and write where each unit
+    // would end up this tick into next[slot - begin]
+    static void integrate(UnitStore& units, float dt, size_t begin, size_t end, glm::vec3* next) {
+        size_t i = begin;
+#ifdef USE_SIMD_STEERING
+        const __m128 vdt = _mm_set1_ps(dt);
+        const __m128 maxSpeed = _mm_set1_ps(MAX_SPEED);
+        const __m128 stopSpeed = _mm_set1_ps(STOP_SPEED);
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        for (; i + 4 <= end; i += 4) {
+            __m128 ax, ay, az, vx, vy, vz, px, py, pz;
+            load4(&units.steering[i].x, ax, ay, az);
+            load4(&units.velocity[i].x, vx, vy, vz);
+            load4(&units.position[i].x, px, py, pz);
+
+            // Acceleration
+            vx = _mm_add_ps(vx, _mm_mul_ps(ax, vdt));
+            vy = _mm_add_ps(vy, _mm_mul_ps(ay, vdt));
+            vz = _mm_add_ps(vz, _mm_mul_ps(az, vdt));
+
+            // Speed clamp: lanes over the limit scale down to it, the rest keep 1
+            __m128 len = _mm_sqrt_ps(dot(vx, vy, vz));
+            __m128 over = _mm_cmpgt_ps(len, maxSpeed);
+            __m128 clamp = _mm_mul_ps(_mm_div_ps(one, len), maxSpeed);
+            __m128 scale = _mm_or_ps(_mm_and_ps(over, clamp), _mm_andnot_ps(over, one));
+
+            // Friction
+            scale = _mm_mul_ps(scale, _mm_setr_ps(damping(units, i), damping(units, i + 1),
+                                                  damping(units, i + 2), damping(units, i + 3)));
+            vx = _mm_mul_ps(vx, scale);
+            vy = _mm_mul_ps(vy, scale);
+            vz = _mm_mul_ps(vz, scale);
+
+            // Snap near-stopped lanes to zero
+            __m128 moving = _mm_cmpge_ps(_mm_sqrt_ps(dot(vx, vy, vz)), stopSpeed);
+            vx = _mm_and_ps(vx, moving);
+            vy = _mm_and_ps(vy, moving);
+            vz = _mm_and_ps(vz, moving);
+            store4(&units.velocity[i].x, vx, vy, vz);
+
+            // Predicted position
+            px = _mm_add_ps(px, _mm_mul_ps(vx, vdt));
+            py = _mm_add_ps(py, _mm_mul_ps(vy, vdt));
+            pz = _mm_add_ps(pz, _mm_mul_ps(vz, vdt));
+            store4(&next[i - begin].x, px, py, pz);
+        }
+#endif
+        integrateScalar(units, dt, i, end, next + (i - begin));
+    }
+
+    // Same as integrate(), one unit at a time (the remainder of a batch, or no SSE)
+    static void integrateScalar(UnitStore& units, float dt, size_t begin, size_t end, glm::vec3* next) {
+        for (size_t i = begin; i < end; i++) {
+            glm::vec3& v = units.velocity[i];
+            v += units.steering[i] * dt;
+
+            float len = std::sqrt(glm::dot(v, v));
+            float scale = (len > MAX_SPEED) ? (1.0f / len) * MAX_SPEED : 1.0f;
+            v *= scale * damping(units, i);
+
+            if (std::sqrt(glm::dot(v, v)) < STOP_SPEED) v = glm::vec3(0.0f);
+
+            next[i - begin] = units.position[i] + v * dt;
+        }
+    }
+
+    // Keep slots [begin, end) off the border rocks (the "invisible wall"), whatever pushed them there
+    static void clampToMap(UnitStore& units, size_t begin, size_t end) {
+        size_t i = begin;
+#ifdef USE_SIMD_STEERING
+        const __m128 lo = _mm_set1_ps(BORDER_SIZE);
+        const __m128 hi = _mm_set1_ps(MAP_SIZE - BORDER_SIZE);
+        for (; i + 4 <= end; i += 4) {
+            __m128 px, py, pz;
+            load4(&units.position[i].x, px, py, pz);
+            px = _mm_min_ps(_mm_max_ps(px, lo), hi);
+            pz = _mm_min_ps(_mm_max_ps(pz, lo), hi);
+            store4(&units.position[i].x, px, py, pz);
+        }
+#endif
+        const float minCoord = BORDER_SIZE, maxCoord = MAP_SIZE - BORDER_SIZE;
+        for (; i < end; i++) {
+            glm::vec3& p = units.position[i];
+            p.x = std::min(std::max(p.x, minCoord), maxCoord);
+            p.z = std::min(std::max(p.z, minCoord), maxCoord);
+        }
+    }
+
+private:
+    static float damping(const UnitStore& units, size_t i) {
+        return (units.state[i] == UnitState::MOVING) ? MOVING_DAMPING : IDLE_DAMPING;
+    }
+
+#ifdef USE_SIMD_STEERING
+    // Same summation order as glm::dot, so both paths round alike
+    static __m128 dot(__m128 x, __m128 y, __m128 z) {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    }
+
+    // Four packed vec3s (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) to x, y, z lanes
+    static void load4(const float* p, __m128& x, __m128& y, __m128& z) {
+        __m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4), c = _mm_loadu_ps(p + 8);
+        x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 3, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                           _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                           _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+    }
+
+    // And back
+    static void store4(float* p, __m128 x, __m128 y, __m128 z) {
+        __m128 a = _mm_shuffle_ps(_mm_unpacklo_ps(x, y), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+        __m128 b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                                  _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_unpackhi_ps(y, z), _MM_SHUFFLE(3, 2, 2, 0));
+        _mm_storeu_ps(p, a);
+        _mm_storeu_ps(p + 4, b);
+        _mm_storeu_ps(p + 8, c);
+    }
+#endif
+};
@@ -5,6 +5,14 @@
 #include <iostream>
 #include <string>
 #include "Pathfinder.h"
+#include "FlowField.h"
+#include "CooperativePathfinder.h"
+#include "PathRequestService.h"
+#include "PathCache.h"
+#include "ChasePlanner.h"
+#include "SpatialHash.h"
+#include "UnitEvents.h"
+#include "SteeringIntegrator.h"
 #include "Building.h"
 #include "ParticleManager.h"
 #include <algorithm> 
@@ -21,39 +29,60 @@ const float GATHER_SPEED = 1.0f;       // Seconds per "chop"
 const int   STAMINA_COST_PER_TREE = 1;
 const int   RESOURCE_PER_TICK = 10;
 const float STAMINA_DRAIN = 1.0f;
+const float CHASE_REPATH_DISTANCE = 2.0f; // Target must move this far from our path's goal before we repath
+const int   SEPARATION_NEIGHBORS = 8;     // Closest units that push us apart
+const float SEPARATION_RADIUS = 10.0f;
+const float SIGHT_RANGE = 25.0f;          // Idle soldiers attack enemies this close on their own
+const float ACQUIRE_INTERVAL = 0.25f;     // Seconds between looks around for enemies
+const int   ATTACK_SPREAD = 4;            // A unit picks among this many closest enemies, so a blob splits its fire
 
 int Unit::NextID = 0;
+HandleTable<Unit> Unit::Handles;
+ObjectPool<Unit> Unit::Pool;
+UnitStore Unit::Store;
+
+void* Unit::operator new(size_t size) {
+    if (size != sizeof(Unit)) return ::operator new(size); // Not a plain Unit, the pool's blocks won't fit
+    return Pool.allocate();
+}
+
+void Unit::operator delete(void* p, size_t size) {
+    if (size != sizeof(Unit)) ::operator delete(p);
+    else Pool.deallocate(p);
+}
 
 
 // CONSTRUCTOR
 Unit::Unit(UnitType type, const glm::vec3& pos, int teamID)
-    : type_(type), position_(pos), teamID_(teamID), velocity_(0.0f), mesh_(nullptr)
+    : mesh_(nullptr)
 {
     id_ = ++NextID; // Assign Unique ID
+    handle_ = Handles.add(this);
+    slot_ = Store.add(this, type, pos, teamID, 0);
 
     // Initialize Stats
-    if (type_ == UnitType::WORKER) {
+    if (type == UnitType::WORKER) {
         maxHealth_ = 50;
         damage_ = 2; // Weak
         attackRange_ = 3.0f; // Melee
         attackCooldown_ = 1.0f;
     }
-    else if (type_ == UnitType::MELEE) {
+    else if (type == UnitType::MELEE) {
         maxHealth_ = 150;
         damage_ = 15;
         attackRange_ = 3.5f; // Melee reach
         attackCooldown_ = 1.2f;
     }
-    else if (type_ == UnitType::RANGED) {
+    else if (type == UnitType::RANGED) {
         maxHealth_ = 80;
         damage_ = 10;
         attackRange_ = 15.0f; // Shoots from far away
         attackCooldown_ = 1.5f;
     }
-    currentHealth_ = maxHealth_;
+    health() = maxHealth_;
 
     // Load Models
-    if (type_ == UnitType::WORKER) {
+    if (type == UnitType::WORKER) {
         if (!minionMesh) {
             std::cout << "Loading Worker Model..." << std::endl;
             minionMesh = new SkinnedMesh("models/Skeleton_Minion.fbx");
@@ -61,7 +90,7 @@ Unit::Unit(UnitType type, const glm::vec3& pos, int teamID)
         }
         mesh_ = minionMesh;
     }
-    else if (type_ == UnitType::MELEE) {
+    else if (type == UnitType::MELEE) {
         if (!warriorMesh) {
             std::cout << "Loading Warrior Model..." << std::endl;
             warriorMesh = new SkinnedMesh("models/Skeleton_Warrior.fbx");
@@ -69,7 +98,7 @@ Unit::Unit(UnitType type, const glm::vec3& pos, int teamID)
         }
         mesh_ = warriorMesh;
     }
-    else if (type_ == UnitType::RANGED) {
+    else if (type == UnitType::RANGED) {
         if (!mageMesh) {
             std::cout << "Loading Mage Model..." << std::endl;
             mageMesh = new SkinnedMesh("models/Skeleton_Mage.fbx");
@@ -78,17 +107,23 @@ Unit::Unit(UnitType type, const glm::vec3& pos, int teamID)
         mesh_ = mageMesh;
     }
 
-    velocity_ = glm::vec3(0.0f);
-    position_.y = 0.0f;
+    velocity() = glm::vec3(0.0f);
+    position().y = 0.0f;
 }
 
 Unit::~Unit() {
     // We do NOT delete mesh_ here because it is shared/static.
+    cancelPathRequest();
+    Handles.remove(handle_);
+
+    // Someone else's hot state fills our slot now
+    Unit* moved = Store.remove(slot_);
+    if (moved) moved->slot_ = slot_;
 }
 
 // TASK HELPERS
 void Unit::assignGatherTask(int obstacleID) {
-    if (type_ != UnitType::WORKER) {
+    if (type() != UnitType::WORKER) {
         std::cout << "Only workers can gather resources!" << std::endl;
         return;
     }
@@ -99,9 +134,10 @@ void Unit::assignGatherQueue(const std::vector<int>& resourceIDs) {
     if (resourceIDs.empty()) return;
 
     // Clear previous tasks
+    cancelPathRequest();
     taskQueue_.clear();
     m_HasTarget = false;
-    state_ = UnitState::IDLE;
+    state() = UnitState::IDLE;
 
     // Create a local copy to shuffle
     std::vector<int> shuffledResources = resourceIDs;
@@ -111,95 +147,197 @@ void Unit::assignGatherQueue(const std::vector<int>& resourceIDs) {
     static std::mt19937 g(rd());
     std::shuffle(shuffledResources.begin(), shuffledResources.end(), g);
 
-    // Fill the queue
+    // Fill the queue (a full queue drops the rest)
     for (int id : shuffledResources) {
-        taskQueue_.push_back(id);
+        if (!taskQueue_.push_back(id)) break;
     }
 
     // Start immediately if we have a task
     if (!taskQueue_.empty()) {
-        state_ = UnitState::IDLE; // The Update loop will pick up the task in the IDLE block
+        state() = UnitState::IDLE; // The Update loop will pick up the task in the IDLE block
     }
 }
 
 void Unit::assignAttackQueue(const std::vector<Unit*>& enemies) {
     if (enemies.empty()) return;
 
-    // Create a local copy so we can shuffle it
-    std::vector<Unit*> shuffledTargets = enemies;
-
-    // Shuffle the list randomly
-    // This ensures 50 warriors don't all chase the exact same skeleton first
-    static std::random_device rd;
-    static std::mt19937 g(rd());
-    std::shuffle(shuffledTargets.begin(), shuffledTargets.end(), g);
-
     // Reset State
+    cancelPathRequest();
     taskQueue_.clear();
     m_HasTarget = false;
     m_Path.clear();
+    m_Flow.reset();
     attackQueue_.clear();
 
-    // Fill Queue with Shuffled IDs
-    for (Unit* u : shuffledTargets) {
-        if (u && u->getID() != id_) {
-            attackQueue_.push_back(u->getID());
+    // Fill Queue with Handles (in any order, see takeNextQueuedTarget)
+    if (enemies.size() <= attackQueue_.CAPACITY) {
+        for (Unit* u : enemies) {
+            if (u && u != this) attackQueue_.push_back(u->getHandle());
+        }
+    }
+    else {
+        // More than fit: queue the closest ones (the rest are left to auto-acquire)
+        static std::vector<std::pair<float, Unit*>> byDistance; // Orders come from the main thread only
+        byDistance.clear();
+        for (Unit* u : enemies) {
+            if (u && u != this) byDistance.push_back(std::make_pair(glm::distance(position(), u->getPosition()), u));
         }
+        size_t keep = std::min(byDistance.size(), (size_t)attackQueue_.CAPACITY);
+        std::nth_element(byDistance.begin(), byDistance.begin() + keep, byDistance.end());
+        for (size_t i = 0; i < keep; i++) attackQueue_.push_back(byDistance[i].second->getHandle());
     }
 
     // Start attacking the first one immediately
-    if (!attackQueue_.empty()) {
-        targetID_ = attackQueue_.front();
-        attackQueue_.pop_front();
-        state_ = UnitState::ATTACKING;
+    if (takeNextQueuedTarget()) {
+        state() = UnitState::ATTACKING;
+    }
+}
+
+// One pass over the queue, no sorting: drops the dead, keeps the ATTACK_SPREAD closest
+// and takes one of those by our ID, so 50 warriors don't all chase the same skeleton
+bool Unit::takeNextQueuedTarget() {
+    size_t best[ATTACK_SPREAD];
+    float bestD2[ATTACK_SPREAD];
+    int found = 0;
+
+    size_t live = 0;
+    for (size_t i = 0; i < attackQueue_.size(); i++) {
+        Unit* u = Unit::resolve(attackQueue_[i]);
+        if (!u || u->isDead()) continue;
+        attackQueue_[live] = attackQueue_[i];
+
+        glm::vec3 d = u->getPrevPosition() - position();
+        float d2 = d.x * d.x + d.z * d.z;
+        if (found < ATTACK_SPREAD || d2 < bestD2[found - 1]) {
+            if (found < ATTACK_SPREAD) found++;
+            int j = found - 1;
+            for (; j > 0 && bestD2[j - 1] > d2; j--) {
+                best[j] = best[j - 1];
+                bestD2[j] = bestD2[j - 1];
+            }
+            best[j] = live;
+            bestD2[j] = d2;
+        }
+        live++;
+    }
+    attackQueue_.truncate(live);
+
+    if (found == 0) {
+        targetUnit_ = UnitHandle();
+        return false;
     }
+    size_t pick = best[id_ % found];
+    targetUnit_ = attackQueue_[pick];
+    attackQueue_.erase(pick);
+    return true;
+}
+
+void Unit::acquireTarget(float dt, const TeamSpatialIndex& hostiles) {
+    acquireTimer_ += dt;
+    if (acquireTimer_ < ACQUIRE_INTERVAL) return;
+    acquireTimer_ = 0.0f;
+
+    // Idle with nothing to do, or chasing someone who is not even in sight
+    Unit* current = Unit::resolve(targetUnit_);
+    bool idle = state() == UnitState::IDLE && taskQueue_.empty() && !isPathRequested();
+    bool chasing = state() == UnitState::MOVING && current && !current->isDead();
+    if (!idle && !chasing) return;
+    if (chasing && glm::distance(position(), current->getPrevPosition()) <= SIGHT_RANGE) return;
+
+    static thread_local std::vector<SpatialHash::Neighbor> nearby;
+    hostiles.nearestHostiles(position(), ATTACK_SPREAD, SIGHT_RANGE, team(), nearby);
+    if (nearby.empty()) return;
+
+    if (chasing) attackQueue_.push_back(targetUnit_); // Still on the list for later (if there is room)
+    targetUnit_ = nearby[id_ % nearby.size()].entry->unit->getHandle();
+    state() = UnitState::MOVING;
+    m_HasTarget = false; // The chase logic asks for a path right away
+    m_Path.clear();
+    m_Flow.reset();
 }
 
 void Unit::assignAttackTask(Unit* enemy) {
-    if (!enemy || enemy == this || enemy->getTeam() == teamID_) return;
+    if (!enemy || enemy == this || enemy->getTeam() == team()) return;
 
-    // Use ID instead of pointer
-    targetID_ = enemy->getID();
+    // Use a handle instead of a pointer: it goes stale when the enemy dies
+    targetUnit_ = enemy->getHandle();
     attackQueue_.clear(); // Clear any queued enemies if we manually clicked one
 
-    state_ = UnitState::ATTACKING;
+    state() = UnitState::ATTACKING;
 
     // Clear other non-combat tasks
+    cancelPathRequest();
     taskQueue_.clear();
     m_HasTarget = false;
     m_Path.clear();
+    m_Flow.reset();
 }
 
 void Unit::assignAttackTask(Building* building) {
-    if (!building || building->getTeam() == teamID_) return;
+    if (!building || building->getTeam() == team()) return;
 
-    targetBuilding_ = building;
-    state_ = UnitState::ATTACKING_BUILDING;
+    targetBuilding_ = building->getHandle();
+    state() = UnitState::ATTACKING_BUILDING;
 
     // Clear other targets
-    targetID_ = -1;
+    cancelPathRequest();
+    targetUnit_ = UnitHandle();
     attackQueue_.clear();
     taskQueue_.clear();
     m_HasTarget = false;
     m_Path.clear();
+    m_Flow.reset();
 }
 
 void Unit::takeDamage(int dmg) {
-    currentHealth_ -= dmg;
+    health() -= dmg;
+}
+
+bool Unit::isBusy() const {
+    UnitState s = state();
+    if (s == UnitState::MOVING || s == UnitState::ATTACKING || s == UnitState::ATTACKING_BUILDING) return true;
+    if (s == UnitState::IDLE && !taskQueue_.empty()) return true; // Starts its next task on the next update
+    if (isPathRequested() || selected()) return true;
+    // Still moving (a push too weak to move us leaves velocity at zero and can wait)
+    return velocity() != glm::vec3(0.0f);
 }
 
-void Unit::update(float dt, const Terrain* terrain, const std::vector<std::unique_ptr<Unit>>& allUnits,
-    Resources& globalResources, Environment* env, NavigationGrid* navGrid)
+void Unit::resolveCombat(CombatLog& combat) {
+    combat.resolve(Store);
+}
+
+void Unit::update(float dt, const SpatialHash& neighbors, const TeamSpatialIndex& hostiles,
+    Environment* env, NavigationGrid* navGrid, UnitEvents& events)
 {
+    // 0. PATH RESULTS (Requests sent on earlier frames)
+    if (m_PathTicket != 0) {
+        PathRequestService* service = PathRequestService::getActive();
+        std::shared_ptr<const WaypointPath> path;
+        PathRequestStatus status = service ? service->poll(m_PathTicket, path) : PathRequestStatus::UNKNOWN;
+
+        if (status != PathRequestStatus::PENDING) {
+            PathPurpose purpose = m_PathPurpose;
+            m_PathTicket = 0;
+            m_PathPurpose = PathPurpose::NONE;
+            if (status == PathRequestStatus::READY) {
+                if (purpose != PathPurpose::CHASE) events.storePath(m_RequestStart, m_RequestTarget, path, m_RequestVersion);
+                receivePath(path, purpose);
+            }
+        }
+    }
+
+    // AUTO-ACQUIRE (Soldiers pick fights with enemies in sight)
+    if (type() != UnitType::WORKER) acquireTarget(dt, hostiles);
+
     // 1. STATE MACHINE
     // --- STATE: IDLE (Looking for work) ---
-    if (state_ == UnitState::IDLE && !taskQueue_.empty()) {
+    if (state() == UnitState::IDLE && !taskQueue_.empty() && !isPathRequested()) {
         currentTargetID_ = taskQueue_.front();
         if (env) {
             Obstacle* obs = env->getObstacleById(currentTargetID_);
             if (obs && obs->active) {
                 // Calculate direction to edge of tree
-                glm::vec3 dir = obs->position - position_;
+                glm::vec3 dir = obs->position - position();
                 if (glm::length(dir) > 0.001f) dir = glm::normalize(dir);
                 else dir = glm::vec3(1, 0, 0);
 
@@ -207,17 +345,8 @@ void Unit::update(float dt, const Terrain* terrain, const std::vector<std::uniqu
                 float stopDistance = obs->radius + 1.5f;
                 glm::vec3 gatherSpot = obs->position - (dir * stopDistance);
 
-                // Find path
-                std::vector<glm::vec3> path = Pathfinder::findPath(position_, gatherSpot, navGrid);
-
-                if (!path.empty()) {
-                    setPath(path);
-                    state_ = UnitState::MOVING; // Move first, Gather later
-                }
-                else {
-                    std::cout << "Path to resource blocked." << std::endl;
-                    taskQueue_.pop_front();
-                }
+                // Find path (Move first, Gather later)
+                requestPath(gatherSpot, PathPurpose::GATHER);
             }
             else {
                 taskQueue_.pop_front();
@@ -226,57 +355,71 @@ void Unit::update(float dt, const Terrain* terrain, const std::vector<std::uniqu
     }
 
     // --- STATE: MOVING (Travel & Chase Logic) ---
-    if (state_ == UnitState::MOVING) {
+    if (state() == UnitState::MOVING) {
 
         // Moving to Attack UNIT
-        if (targetID_ != -1) {
-            Unit* targetUnit = nullptr;
-            for (const auto& u : allUnits) { if (u->getID() == targetID_) { targetUnit = u.get(); break; } }
+        if (!targetUnit_.isNull()) {
+            Unit* targetUnit = Unit::resolve(targetUnit_);
 
             if (!targetUnit || targetUnit->isDead()) {
-                targetID_ = -1; // Target lost
-                // Check queue or go idle (logic handled at end of block)
+                // Target lost: on to the next one queued, or finish the path and go idle
+                if (takeNextQueuedTarget()) m_HasTarget = false;
             }
             else {
-                float dist = glm::distance(position_, targetUnit->getPosition());
+                float dist = glm::distance(position(), targetUnit->getPrevPosition());
                 float reach = attackRange_ + 1.0f;
 
                 if (dist <= reach) {
                     // ARRIVED -> Switch to Action
-                    state_ = UnitState::ATTACKING;
-                    velocity_ = glm::vec3(0.0f);
+                    state() = UnitState::ATTACKING;
+                    velocity() = glm::vec3(0.0f);
                     m_Path.clear();
+                    m_Flow.reset();
                     m_HasTarget = false;
                 }
                 else {
                     // CHASE LOGIC (Moved here from Attacking state)
+                    // Only repath if the target got away from where our path leads,
+                    // or the map changed under the rest of the path
                     repathTimer_ += dt;
-                    if (repathTimer_ > 0.5f || !m_HasTarget) {
+                    if ((repathTimer_ > 0.5f || !m_HasTarget) && !isPathRequested()) {
                         repathTimer_ = 0.0f;
-                        std::vector<glm::vec3> path = Pathfinder::findPath(position_, targetUnit->getPosition(), navGrid);
-                        if (path.size() > 2) path.pop_back();
-                        setPath(path);
+                        bool targetMoved = glm::distance(targetUnit->getPrevPosition(), m_PathGoal) > CHASE_REPATH_DISTANCE;
+                        if (!m_HasTarget || targetMoved || isPathAffected(navGrid)) {
+                            requestPath(targetUnit->getPrevPosition(), PathPurpose::CHASE);
+                        }
                     }
                 }
             }
         }
         // Moving to Attack BUILDING
-        else if (targetBuilding_) {
-            if (targetBuilding_->isDead()) {
-                targetBuilding_ = nullptr;
+        else if (!targetBuilding_.isNull()) {
+            Building* targetBuilding = Building::resolve(targetBuilding_);
+            if (!targetBuilding || targetBuilding->isDead()) {
+                targetBuilding_ = BuildingHandle();
             }
             else {
                 float buildingRadius = 14.0f;
                 float effectiveRange = buildingRadius + attackRange_ + 5.0f;
-                float dist = glm::distance(position_, targetBuilding_->getPosition());
+                float dist = glm::distance(position(), targetBuilding->getPosition());
 
                 if (dist <= effectiveRange) {
                     // ARRIVED -> Switch to Action
-                    state_ = UnitState::ATTACKING_BUILDING;
-                    velocity_ = glm::vec3(0.0f);
+                    state() = UnitState::ATTACKING_BUILDING;
+                    velocity() = glm::vec3(0.0f);
                     m_Path.clear();
+                    m_Flow.reset();
                     m_HasTarget = false;
                 }
+                else if (!m_HasTarget && !isPathRequested()) {
+                    // No route (pushed away, or the group order had none for us):
+                    // head for the near side of the building, just inside our reach
+                    glm::vec3 dir = position() - targetBuilding->getPosition();
+                    dir.y = 0;
+                    if (glm::length(dir) > 0.001f) dir = glm::normalize(dir);
+                    else dir = glm::vec3(1, 0, 0);
+                    requestPath(targetBuilding->getPosition() + dir * (effectiveRange - 2.0f), PathPurpose::REROUTE);
+                }
                 // (Building is static, no need to re-path constantly)
             }
         }
@@ -284,14 +427,15 @@ void Unit::update(float dt, const Terrain* terrain, const std::vector<std::uniqu
         else if (currentTargetID_ != -1 && env) {
             Obstacle* target = env->getObstacleById(currentTargetID_);
             if (target && target->active) {
-                float dist = glm::distance(position_, target->position);
+                float dist = glm::distance(position(), target->position);
                 float reach = target->radius + 5.0f;
 
                 if (dist <= reach) {
                     // ARRIVED -> Switch to Action
-                    state_ = UnitState::GATHERING;
-                    velocity_ = glm::vec3(0.0f);
+                    state() = UnitState::GATHERING;
+                    velocity() = glm::vec3(0.0f);
                     m_Path.clear();
+                    m_Flow.reset();
                     m_HasTarget = false;
                 }
             }
@@ -300,121 +444,126 @@ void Unit::update(float dt, const Terrain* terrain, const std::vector<std::uniqu
             }
         }
 
+        // EXECUTE MOVEMENT (Flow Field)
+        if (!m_Flow) m_Group.reset(); // Left the group move (arrived or new orders)
+        if (state() == UnitState::MOVING && m_Flow) {
+            if (m_Group) m_Group->report(m_GroupMember, position());
+
+            glm::vec3 toSlot = m_FlowSlot - position();
+            toSlot.y = 0;
+            bool slotUnreachable = !m_Flow->isReachable(m_FlowSlot); // On a rock or walled off
+
+            if (glm::length(toSlot) < 1.0f || (slotUnreachable && m_Flow->isInGoal(position()))) {
+                // Reached our formation spot (or the closest we can get to it)
+                m_Flow.reset();
+                m_Group.reset();
+                m_HasTarget = false;
+                velocity() = glm::vec3(0.0f);
+            }
+            else if (!isPathRequested() && (!m_Flow->isReachable(position()) || isFlowAffected(navGrid))) {
+                // Shoved off the field, or something was built across our way down it:
+                // walk the rest with a normal path
+                requestPath(m_FlowSlot, PathPurpose::REROUTE);
+            }
+        }
+
         // EXECUTE MOVEMENT (Standard Path Following)
-        if (state_ == UnitState::MOVING) { // Only if we didn't switch state above
+        if (state() == UnitState::MOVING) { // Only if we didn't switch state above
+            // Something was built on the rest of our route: find a new one (chasers handle this above)
+            if (m_HasTarget && !m_Path.empty() && targetUnit_.isNull() && !isPathRequested() && isPathAffected(navGrid)) {
+                requestPath(m_Path.back(), PathPurpose::REROUTE);
+            }
+
             if (m_HasTarget && !m_Path.empty()) {
                 glm::vec3 targetPoint = m_Path.front();
-                glm::vec3 dir = targetPoint - position_;
+                glm::vec3 dir = targetPoint - position();
                 dir.y = 0;
                 float dist = glm::length(dir);
-                float stopRadius = (m_Path.size() == 1) ? 1.0f : 0.5f;
+                float stopRadius = (m_Path.remaining() == 1) ? 1.0f : 0.5f;
 
                 if (dist < stopRadius) {
-                    m_Path.erase(m_Path.begin());
+                    m_Path.advance();
                     if (m_Path.empty()) {
                         m_HasTarget = false;
-                        velocity_ = glm::vec3(0.0f);
+                        velocity() = glm::vec3(0.0f);
 
                         // If path ended and we still haven't reached our "Action State",
                         // it means we are just moving to a spot (Right Click on Ground).
-                        if (targetID_ == -1 && currentTargetID_ == -1 && !targetBuilding_) {
-                            state_ = UnitState::IDLE;
+                        if (targetUnit_.isNull() && currentTargetID_ == -1 && targetBuilding_.isNull()) {
+                            state() = UnitState::IDLE;
                         }
                     }
                 }
             }
             // Fail-safe
-            if (!m_HasTarget && state_ == UnitState::MOVING) {
+            if (!m_HasTarget && state() == UnitState::MOVING) {
                 // If we have a target but no path, go Idle.
-                if (targetID_ == -1 && currentTargetID_ == -1 && !targetBuilding_) {
-                    state_ = UnitState::IDLE;
+                if (targetUnit_.isNull() && currentTargetID_ == -1 && targetBuilding_.isNull()) {
+                    state() = UnitState::IDLE;
                 }
             }
         }
     }
 
     // --- STATE: ATTACKING (Action Only) ---
-    if (state_ == UnitState::ATTACKING) {
-        Unit* targetUnit = nullptr;
-        if (targetID_ != -1) {
-            for (const auto& u : allUnits) { if (u->getID() == targetID_) { targetUnit = u.get(); break; } }
-        }
+    if (state() == UnitState::ATTACKING) {
+        Unit* targetUnit = Unit::resolve(targetUnit_);
 
         if (!targetUnit || targetUnit->isDead()) {
             // Target dead, check queue or Idle
-            if (!attackQueue_.empty()) {
-                targetID_ = attackQueue_.front();
-                attackQueue_.pop_front();
-                state_ = UnitState::MOVING; // Switch back to moving to chase new target
+            if (takeNextQueuedTarget()) {
+                state() = UnitState::MOVING; // Switch back to moving to chase new target
             }
             else {
-                state_ = UnitState::IDLE;
-                targetID_ = -1;
+                state() = UnitState::IDLE;
             }
         }
         else {
             // Check if target ran away
-            float dist = glm::distance(position_, targetUnit->getPosition());
+            float dist = glm::distance(position(), targetUnit->getPrevPosition());
             float reach = attackRange_ + 1.0f;
 
             if (dist > reach) {
-                state_ = UnitState::MOVING; // Switch back to moving to chase
+                state() = UnitState::MOVING; // Switch back to moving to chase
             }
             else {
                 // HIT LOGIC
-                velocity_ = glm::vec3(0.0f); // Ensure we stay still
+                velocity() = glm::vec3(0.0f); // Ensure we stay still
                 attackTimer_ += dt;
                 if (attackTimer_ >= attackCooldown_) {
                     attackTimer_ = 0.0f;
-                    targetUnit->takeDamage(damage_);
-                }
-                // MAGE PARTICLE BEAM
-                if (type_ == UnitType::RANGED) {
-                    // Calculate start (mage hand) and end (enemy body)
-                    glm::vec3 mageHand = position_ + glm::vec3(-2.0f, 2.5f, 1.0f);
-                    glm::vec3 enemyBody = targetUnit->getPosition() + glm::vec3(0.0f, 2.0f, 0.0f);
-
-                    // 1. Create the beam line
-                    ParticleManager::addMageBeam(mageHand, enemyBody);
-
-                    // 2. Create a small impact burst at the enemy
-                    ParticleManager::addMageImpact(enemyBody);
+                    // Mages fire a beam from their hand to the enemy body
+                    glm::vec3 mageHand = position() + glm::vec3(-2.0f, 2.5f, 1.0f);
+                    glm::vec3 enemyBody = targetUnit->getPrevPosition() + glm::vec3(0.0f, 2.0f, 0.0f);
+                    events.attack(handle_, targetUnit_, damage_, type() == UnitType::RANGED, mageHand, enemyBody);
                 }
             }
         }
     }
 
     // --- STATE: ATTACKING BUILDING (Action Only) ---
-    if (state_ == UnitState::ATTACKING_BUILDING) {
-        if (!targetBuilding_ || targetBuilding_->isDead()) {
-            state_ = UnitState::IDLE;
-            targetBuilding_ = nullptr;
+    if (state() == UnitState::ATTACKING_BUILDING) {
+        Building* targetBuilding = Building::resolve(targetBuilding_);
+        if (!targetBuilding || targetBuilding->isDead()) {
+            state() = UnitState::IDLE;
+            targetBuilding_ = BuildingHandle();
         }
         else {
             float buildingRadius = 14.0f;
             float effectiveRange = buildingRadius + attackRange_ + 5.0f;
-            float dist = glm::distance(position_, targetBuilding_->getPosition());
+            float dist = glm::distance(position(), targetBuilding->getPosition());
 
             if (dist > effectiveRange) {
-                state_ = UnitState::MOVING; // Go back to moving if pushed away
+                state() = UnitState::MOVING; // Go back to moving if pushed away
             }
             else {
-                velocity_ = glm::vec3(0.0f);
+                velocity() = glm::vec3(0.0f);
                 attackTimer_ += dt;
                 if (attackTimer_ >= attackCooldown_) {
                     attackTimer_ = 0.0f;
-                    targetBuilding_->takeDamage((float)damage_);
-                }
-                if (type_ == UnitType::RANGED) {
-                    // Calculate start (mage hand) and end (enemy body)
-                    glm::vec3 mageHand = position_ + glm::vec3(-2.0f, 2.5f, 1.0f);
-                    glm::vec3 enemyBody = targetBuilding_->getPosition() + glm::vec3(0.0f, 5.0f, 0.0f);
-
-                    // 1. Create the beam line
-                    ParticleManager::addMageBeam(mageHand, enemyBody);
-
-                    // 2. Create a small impact burst at the enemy
-                    ParticleManager::addMageImpact(enemyBody);
+                    glm::vec3 mageHand = position() + glm::vec3(-2.0f, 2.5f, 1.0f);
+                    glm::vec3 enemyBody = targetBuilding->getPosition() + glm::vec3(0.0f, 5.0f, 0.0f);
+                    events.attack(handle_, targetBuilding_, damage_, type() == UnitType::RANGED, mageHand, enemyBody);
                 }
             }
 
@@ -422,32 +571,29 @@ void Unit::update(float dt, const Terrain* terrain, const std::vector<std::uniqu
     }
 
     // --- STATE: GATHERING (Action Only) ---
-    if (state_ == UnitState::GATHERING && env) {
+    if (state() == UnitState::GATHERING && env) {
         Obstacle* target = env->getObstacleById(currentTargetID_);
         if (!target || !target->active) {
-            state_ = UnitState::IDLE; // Resource gone
+            state() = UnitState::IDLE; // Resource gone
         }
         else {
-            float dist = glm::distance(position_, target->position);
+            float dist = glm::distance(position(), target->position);
             float reach = target->radius + 5.0f;
 
             if (dist > reach) {
-                state_ = UnitState::MOVING; // Go back to moving if pushed away
+                state() = UnitState::MOVING; // Go back to moving if pushed away
             }
             else {
                 // CHOP LOGIC
-                velocity_ = glm::vec3(0.0f);
+                velocity() = glm::vec3(0.0f);
                 gatherTimer_ += dt;
                 if (gatherTimer_ >= GATHER_SPEED) {
                     gatherTimer_ = 0.0f;
-                    target->resourceAmount -= RESOURCE_PER_TICK;
-                    if (target->type == ObstacleType::TREE) globalResources.addWood(RESOURCE_PER_TICK);
-                    else globalResources.addRock(RESOURCE_PER_TICK);
-
-                    if (target->resourceAmount <= 0) {
-                        target->active = false;
-                        if (navGrid) navGrid->updateArea(target->position, target->radius, false);
-                        state_ = UnitState::IDLE;
+                    events.gather(currentTargetID_, RESOURCE_PER_TICK);
+
+                    // Our chop takes the last of it (the obstacle itself is cleared when the events apply)
+                    if (target->resourceAmount <= RESOURCE_PER_TICK) {
+                        state() = UnitState::IDLE;
                         if (!taskQueue_.empty()) taskQueue_.pop_front();
                     }
                 }
@@ -461,21 +607,48 @@ void Unit::update(float dt, const Terrain* terrain, const std::vector<std::uniqu
 
     // Apply forces ONLY if we have a target or need to separate
     // Check state for movement:
-    bool isMovingState = (state_ == UnitState::MOVING);
+    bool isMovingState = (state() == UnitState::MOVING);
 
     if (isMovingState && m_HasTarget && !m_Path.empty()) {
         glm::vec3 target = m_Path.front();
-        glm::vec3 dir = target - position_;
+        glm::vec3 dir = target - position();
         dir.y = 0;
         dir = glm::normalize(dir);
-        float dist = glm::distance(position_, target);
+        float dist = glm::distance(position(), target);
+
+        // SEEK FORCE
+        float moveSpeed = 150.0f;
+        glm::vec3 seek = dir * moveSpeed;
+
+        // Arrival Braking
+        if (m_Path.remaining() == 1 && dist < 5.0f) {
+            seek *= (dist / 5.0f);
+        }
+        acc += seek;
+    }
+    else if (isMovingState && m_HasTarget && m_Flow) {
+        glm::vec3 toSlot = m_FlowSlot - position();
+        toSlot.y = 0;
+        float dist = glm::length(toSlot);
+
+        // Follow the field until we are inside the goal region, then head for our own slot
+        glm::vec3 dir = m_Flow->isInGoal(position()) ? toSlot / dist : m_Flow->getDirection(position());
+
+        // Cooperative move: head for the cell the group reserved for us this step instead
+        // (slowing down inside the last cell, so a planned wait holds us in place)
+        glm::vec3 step;
+        if (m_Group && m_Group->getStep(m_GroupMember, step)) {
+            glm::vec3 toStep = step - position();
+            toStep.y = 0;
+            dir = toStep / std::max(glm::length(toStep), 1.0f);
+        }
 
         // SEEK FORCE
         float moveSpeed = 150.0f;
         glm::vec3 seek = dir * moveSpeed;
 
         // Arrival Braking
-        if (m_Path.size() == 1 && dist < 5.0f) {
+        if (dist < 5.0f) {
             seek *= (dist / 5.0f);
         }
         acc += seek;
@@ -483,115 +656,270 @@ void Unit::update(float dt, const Terrain* terrain, const std::vector<std::uniqu
 
     // SEPARATION FORCE (Apply in Idle AND when moving to avoid stacking)
     // We apply it slightly stronger in IDLE.
-    if (!allUnits.empty()) {
+    // Pushed by our closest neighbours (not a sample of the whole army)
+    {
+        static thread_local std::vector<SpatialHash::Neighbor> nearby;
+        neighbors.kNearest(position(), SEPARATION_NEIGHBORS, SEPARATION_RADIUS, nearby, this);
+
         glm::vec3 sepForce(0.0f);
-        int neighbors = 0;
-        int checkCount = 8;
-        size_t startIdx = (id_ * 37) % allUnits.size();
-
-        for (int i = 0; i < checkCount; ++i) {
-            size_t idx = (startIdx + i) % allUnits.size();
-            const auto& other = allUnits[idx];
-            if (other.get() == this) continue;
-
-            float d = glm::distance(position_, other->getPosition());
-            if (d < 10.0f && d > 0.01f) {
-                glm::vec3 push = position_ - other->getPosition();
-                push.y = 0;
-                sepForce += glm::normalize(push) / (d*d);
-                neighbors++;
+        int pushing = 0;
+        for (const auto& n : nearby) {
+            glm::vec3 push = position() - n.entry->position;
+            push.y = 0;
+            float d = glm::length(push);
+            if (d < SEPARATION_RADIUS && d > 0.01f) {
+                sepForce += (push / d) / (d*d);
+                pushing++;
             }
         }
-        if (neighbors > 0) {
+        if (pushing > 0) {
             acc += sepForce * 35.0f;
         }
     }
 
 
-    // Calculate Acceleration/Friction 
-    velocity_ += acc * dt;
-    float maxSpeed = 10.0f;
-    if (glm::length(velocity_) > maxSpeed) velocity_ = glm::normalize(velocity_) * maxSpeed;
-
-    if (!isMovingState) velocity_ *= 0.5f;
-    else velocity_ *= 0.95f;
-
-    if (glm::length(velocity_) < 0.1f) velocity_ = glm::vec3(0.0f);
+    // Integrated for all units at once afterwards (see integrateMovement)
+    steering() = acc;
+}
 
-    // PREDICT MOVE
-    glm::vec3 moveStep = velocity_ * dt;
-    glm::vec3 nextPos = position_ + moveStep;
+// 3. MOVEMENT, for store slots [begin, end) after their updates: velocity and the
+// predicted step in SIMD batches, wall sliding and terrain height per unit
+void Unit::integrateMovement(float dt, size_t begin, size_t end, const Terrain* terrain, const NavigationGrid* navGrid) {
+    static thread_local std::vector<glm::vec3> next;
+    next.resize(end - begin);
+    SteeringIntegrator::integrate(Store, dt, begin, end, next.data());
 
     // SMART GRID CHECK (Sliding Logic)
-    if (navGrid->isBlocked((int)nextPos.x, (int)nextPos.z)) {
-        // Try to move only in X
-        glm::vec3 nextX = position_ + glm::vec3(moveStep.x, 0, 0);
-        // Try to move only in Z
-        glm::vec3 nextZ = position_ + glm::vec3(0, 0, moveStep.z);
+    for (size_t i = begin; i < end; i++) {
+        glm::vec3& position = Store.position[i];
+        const glm::vec3& nextPos = next[i - begin];
+        if (navGrid->isBlocked((int)nextPos.x, (int)nextPos.z)) {
+            glm::vec3 moveStep = nextPos - position;
+            // Try to move only in X
+            glm::vec3 nextX = position + glm::vec3(moveStep.x, 0, 0);
+            // Try to move only in Z
+            glm::vec3 nextZ = position + glm::vec3(0, 0, moveStep.z);
+
+            if (!navGrid->isBlocked((int)nextX.x, (int)nextX.z)) {
+                position = nextX; // Slide along the Z-wall
+            }
+            else if (!navGrid->isBlocked((int)nextZ.x, (int)nextZ.z)) {
+                position = nextZ; // Slide along the X-wall
+            }
+            else {
+                Store.velocity[i] = glm::vec3(0.0f); // Cornered: Stop
+            }
+        }
+        else {
+            // Path is clear!
+            position = nextPos;
+        }
+    }
 
-        if (!navGrid->isBlocked((int)nextX.x, (int)nextX.z)) {
-            position_ = nextX; // Slide along the Z-wall
+    // FINAL PHYSICS CLAMP (The "Invisible Wall")
+    // This stops units from being pushed into the border rocks by physics/separation.
+    SteeringIntegrator::clampToMap(Store, begin, end);
+
+    // Now apply height
+    if (terrain) {
+        for (size_t i = begin; i < end; i++) {
+            glm::vec3& position = Store.position[i];
+            position.y = terrain->getHeightAt(position.x, position.z).y;
         }
-        else if (!navGrid->isBlocked((int)nextZ.x, (int)nextZ.z)) {
-            position_ = nextZ; // Slide along the X-wall
+    }
+}
+
+void Unit::setPath(const std::vector<glm::vec3>& newPath) {
+    setPath(std::make_shared<const WaypointPath>(newPath));
+}
+
+void Unit::setPath(const std::shared_ptr<const WaypointPath>& newPath) {
+    m_Path = PathCursor(newPath);
+    m_Flow.reset();
+    m_HasTarget = (!m_Path.empty());
+
+    // Automatically switch state to MOVING if we have a path
+    if (m_HasTarget && state() != UnitState::ATTACKING) {
+        state() = UnitState::MOVING;
+    }
+}
+
+void Unit::moveTo(const glm::vec3& target, NavigationGrid* navGrid) {
+    clearTasks();
+    requestPath(target, PathPurpose::MOVE);
+    submitPathRequest(navGrid);
+}
+
+// Only notes the request: update() may be running on a worker thread, and the cache
+// and the path service are main-thread business (see submitPathRequest)
+void Unit::requestPath(const glm::vec3& target, PathPurpose purpose) {
+    cancelPathRequest();
+
+    m_RequestStart = position();
+    m_RequestTarget = target;
+    m_PathPurpose = purpose;
+    m_SubmitPending = true;
+}
+
+void Unit::submitPathRequest(NavigationGrid* navGrid) {
+    if (!m_SubmitPending) return;
+    m_SubmitPending = false;
+
+    PathPurpose purpose = m_PathPurpose;
+    glm::vec3 start = m_RequestStart, target = m_RequestTarget;
+    m_RequestVersion = navGrid ? navGrid->getVersion() : 0;
+
+    // Chasing: repair our own previous path instead of sharing cached ones
+    std::shared_ptr<ChasePlanner> planner;
+    if (purpose == PathPurpose::CHASE) {
+        if (!m_ChasePlanner) m_ChasePlanner = std::make_shared<ChasePlanner>();
+        planner = m_ChasePlanner;
+    }
+
+    // Same start and goal cell as a recent search, and nothing changed on that path
+    PathCache* cache = planner ? nullptr : PathCache::getActive();
+    std::shared_ptr<const WaypointPath> path;
+    if (cache && cache->lookup(start, target, path)) {
+        m_PathPurpose = PathPurpose::NONE;
+        receivePath(path, purpose);
+        return;
+    }
+
+    PathRequestService* service = PathRequestService::getActive();
+    if (!service) {
+        // No service running: search right now
+        path = std::make_shared<const WaypointPath>(planner ? planner->findPath(start, target, navGrid)
+                                                            : Pathfinder::findPath(start, target, navGrid));
+        if (cache) cache->store(start, target, path, m_RequestVersion);
+        m_PathPurpose = PathPurpose::NONE;
+        receivePath(path, purpose);
+        return;
+    }
+
+    int priority = PathRequestService::PRIORITY_LOW;
+    if (purpose == PathPurpose::CHASE) priority = PathRequestService::PRIORITY_NORMAL;
+    if (purpose == PathPurpose::MOVE || purpose == PathPurpose::REROUTE) priority = PathRequestService::PRIORITY_HIGH;
+
+    m_PathTicket = service->request(start, target, priority, planner);
+}
+
+// Apply a finished search, unless the unit has moved on to something else meanwhile
+void Unit::receivePath(const std::shared_ptr<const WaypointPath>& path, PathPurpose purpose) {
+    if (purpose == PathPurpose::GATHER) {
+        if (state() != UnitState::IDLE || taskQueue_.empty() || taskQueue_.front() != currentTargetID_) return;
+
+        if (!path->empty()) {
+            setPath(path);
+            state() = UnitState::MOVING; // Move first, Gather later
         }
         else {
-            velocity_ = glm::vec3(0.0f); // Cornered: Stop
+            taskQueue_.pop_front(); // Path to resource blocked
         }
     }
+    else if (purpose == PathPurpose::CHASE) {
+        if (state() != UnitState::MOVING || targetUnit_.isNull()) return;
+        // No need to trim the end off: we switch to attacking once the target is in reach
+        setPath(path);
+    }
+    else if (purpose == PathPurpose::MOVE) {
+        setPath(path);
+    }
+    else if (purpose == PathPurpose::REROUTE) {
+        if (state() != UnitState::MOVING) return;
+        setPath(path);
+    }
     else {
-        // Path is clear!
-        position_ = nextPos;
+        return;
     }
 
-    // Terrain Clamp
-    if (position_.x <= 0) position_.x = 0.1f;
-    if (position_.x >= 512) position_.x = 511.9f;
-    if (position_.z <= 0) position_.z = 0.1f;
-    if (position_.z >= 512) position_.z = 511.9f;
+    m_PathGoal = m_RequestTarget;
+    m_PathVersion = m_RequestVersion;
+}
 
-    if (terrain) {
-        position_.y = terrain->getHeightAt(position_.x, position_.z).y;
-    }
+// Same for the way down the flow field: the field is shared and stays as it was built,
+// so each unit checks only the cells it still has to cross
+bool Unit::isFlowAffected(const NavigationGrid* navGrid) {
+    if (!navGrid || !m_Flow || navGrid->getVersion() == m_FlowVersion) return false;
 
-   
-    // FINAL PHYSICS CLAMP (The "Invisible Wall")
-    // This stops units from being pushed into the border rocks by physics/separation.
+    uint64_t since = m_FlowVersion;
+    m_FlowVersion = navGrid->getVersion(); // Don't look at these changes again
+    if (!m_Flow->isChangedSince(since)) return false; // Somewhere else on the map
 
-    float mapSize = 512.0f;
-    float borderSize = 30.0f; // Thickness of the rocks (Safety margin)
+    std::vector<NavigationGrid::DirtyRect> changes;
+    if (!navGrid->getChangesSince(since, changes)) return true;
+
+    return !m_Flow->walkRoute(position(), [&](int x, int z) {
+        for (const auto& rect : changes) {
+            if (rect.contains(x, z) && navGrid->isBlocked(x, z)) return false;
+        }
+        return true;
+    });
+}
 
-    if (position_.x < borderSize) position_.x = borderSize;
-    if (position_.x > mapSize - borderSize) position_.x = mapSize - borderSize;
+// True if a cell on the rest of our path got blocked since the path was searched
+bool Unit::isPathAffected(const NavigationGrid* navGrid) {
+    if (!navGrid || m_Path.empty() || navGrid->getVersion() == m_PathVersion) return false;
 
-    if (position_.z < borderSize) position_.z = borderSize;
-    if (position_.z > mapSize - borderSize) position_.z = mapSize - borderSize;
+    std::vector<NavigationGrid::DirtyRect> changes;
+    bool known = navGrid->getChangesSince(m_PathVersion, changes);
+    m_PathVersion = navGrid->getVersion(); // Don't look at these changes again
+    if (!known) return true;
 
-    // Now apply height
-    if (terrain) {
-        position_.y = terrain->getHeightAt(position_.x, position_.z).y;
+    auto stillClear = [&](int x, int z) {
+        for (const auto& rect : changes) {
+            if (rect.contains(x, z) && navGrid->isBlocked(x, z)) return false;
+        }
+        return true;
+    };
+
+    // Walk the straight legs between the remaining corners (from where we stand)
+    glm::vec3 from = position();
+    for (size_t i = 0; i < m_Path.remaining(); i++) {
+        glm::vec3 to = m_Path.ahead(i);
+        if (!Pathfinder::walkLine((int)from.x, (int)from.z, (int)to.x, (int)to.z, stillClear)) return true;
+        from = to;
     }
+    return false;
 }
 
-void Unit::setPath(const std::vector<glm::vec3>& newPath) {
-    m_Path = newPath;
-    m_HasTarget = (!m_Path.empty());
+void Unit::cancelPathRequest() {
+    if (m_PathTicket != 0) {
+        PathRequestService* service = PathRequestService::getActive();
+        if (service) service->cancel(m_PathTicket);
+    }
+    m_PathTicket = 0;
+    m_PathPurpose = PathPurpose::NONE;
+    m_SubmitPending = false;
+}
 
-    // Automatically switch state to MOVING if we have a path
-    if (m_HasTarget && state_ != UnitState::ATTACKING) {
-        state_ = UnitState::MOVING;
+void Unit::setFlowField(const std::shared_ptr<const FlowField>& field, const glm::vec3& slot) {
+    cancelPathRequest();
+    m_Path.clear();
+    m_Flow = field;
+    m_FlowSlot = slot;
+    m_FlowVersion = field ? field->getVersion() : 0;
+    m_Group.reset();
+    m_HasTarget = (m_Flow != nullptr);
+
+    if (m_HasTarget && state() != UnitState::ATTACKING) {
+        state() = UnitState::MOVING;
     }
 }
 
+void Unit::setMoveGroup(const std::shared_ptr<CooperativeGroup>& group, int member) {
+    m_Group = m_Flow ? group : nullptr;
+    m_GroupMember = member;
+}
+
 void Unit::draw(const glm::mat4& view, const glm::mat4& projection, GLuint shaderProgram, float currentTime) {
     if (!mesh_) return;
 
     // SETUP MODEL MATRIX
-    glm::mat4 model = glm::translate(glm::mat4(1.0f), position_);
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), position());
 
     // Rotate to face movement direction
-    if (glm::length(velocity_) > 0.1f) {
-        glm::vec3 direction = glm::normalize(velocity_);
+    if (glm::length(velocity()) > 0.1f) {
+        glm::vec3 direction = glm::normalize(velocity());
         float angle = atan2(direction.x, direction.z);
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
     }
@@ -2,28 +2,63 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <memory>
-#include <deque>
+#include <cstdint>
 #include "SkinnedMesh.h"
 #include "Resource.h"
 #include "Environment.h"
+#include "WaypointPath.h"
+#include "HandleTable.h"
+#include "UnitStore.h"
+#include "FixedQueue.h"
+#include "ObjectPool.h"
 
 class NavigationGrid;
 class Building; 
+class Unit;
+class FlowField;
+class CooperativeGroup;
+class ChasePlanner;
+class SpatialHash;
+class TeamSpatialIndex;
+class UnitEvents;
+class CombatLog;
+
+typedef Handle<Unit> UnitHandle;
+typedef Handle<Building> BuildingHandle;
 
-enum class UnitType { WORKER, MELEE, RANGED };
-enum class UnitState { IDLE, MOVING, GATHERING, ATTACKING, ATTACKING_BUILDING };
 
 class Unit {
 public:
     Unit(UnitType type, const glm::vec3& pos, int teamID);
     ~Unit();
 
-    void update(float dt, const Terrain* terrain, const std::vector<std::unique_ptr<Unit>>& allUnits,
-        Resources& globalResources, Environment* env, NavigationGrid* navGrid);
+    Unit(const Unit&) = delete;
+    Unit& operator=(const Unit&) = delete;
+
+    // Units live in a pool (see ObjectPool.h): spawning and dying reuse freed blocks
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
+    static const ObjectPool<Unit>& pool() { return Pool; }
+
+    // Longest task and target lists a unit keeps (the queues are stored inline)
+    enum { MAX_TASKS = 32, MAX_ATTACK_TARGETS = 64 };
+
+    // Safe to run for many units at once: changes only this unit, reads other units
+    // through getPrevPosition() and the grid, and records every other effect in `events`.
+    // The grid, obstacles and buildings must not change until the updates are done.
+    // Movement itself happens in integrateMovement, for all units together.
+    // `hostiles` is for finding enemies (auto-acquire); `neighbors` has everyone, for separation.
+    void update(float dt, const SpatialHash& neighbors, const TeamSpatialIndex& hostiles,
+        Environment* env, NavigationGrid* navGrid, UnitEvents& events);
+    // After the updates: move store slots [begin, end) by the forces their updates summed.
+    // Touches only those slots, so disjoint ranges can run on different threads.
+    static void integrateMovement(float dt, size_t begin, size_t end, const Terrain* terrain, const NavigationGrid* navGrid);
+    // Main thread, after the updates (in unit order): send the path request update() made
+    void submitPathRequest(NavigationGrid* navGrid);
 
     void draw(const glm::mat4& view, const glm::mat4& projection, GLuint shaderProgram, float currentTime);
 
-    UnitType getType() const { return type_; }
+    UnitType getType() const { return type(); }
 
     // Expose Meshes publicly so Main can use them
     static SkinnedMesh* minionMesh;
@@ -32,29 +67,43 @@ public:
 
     // Movement
     void setPath(const std::vector<glm::vec3>& newPath);
-    void setSelected(bool s) { selected_ = s; }
-    bool isSelected() const { return selected_; }
-    glm::vec3 getPosition() const { return position_; }
+    void setPath(const std::shared_ptr<const WaypointPath>& newPath);
+    // Player move order: drops current tasks and asks for a path to target
+    void moveTo(const glm::vec3& target, NavigationGrid* navGrid);
+    // Group move: follow a shared flow field, then settle on our own formation slot
+    void setFlowField(const std::shared_ptr<const FlowField>& field, const glm::vec3& slot);
+    // ... and take turns with the rest of the group so our cells never overlap (after setFlowField)
+    void setMoveGroup(const std::shared_ptr<CooperativeGroup>& group, int member);
+    void setSelected(bool s) { selected() = s; }
+    bool isSelected() const { return selected() != 0; }
+    glm::vec3 getPosition() const { return position(); }
+    // Where we were when the current tick started (what other units see during their updates)
+    glm::vec3 getPrevPosition() const { return Store.prevPosition[slot_]; }
+    // Between the last two ticks, for drawing at frame rate (see UnitStore::renderPosition)
+    glm::vec3 getRenderPosition(float alpha) const { return Store.renderPosition(slot_, alpha); }
 
     // Resource Logic
     void assignGatherTask(int obstacleID);
     bool hasStaminaForTask(int cost) const { return currentStamina_ >= cost; }
     float getStamina() const { return currentStamina_; }
-    glm::vec3 getVelocity() const { return velocity_; }
-    // Assigns a list of resources, but randomizes the order
+    glm::vec3 getVelocity() const { return velocity(); }
+    // Assigns a list of resources, but randomizes the order (and keeps at most MAX_TASKS)
     void assignGatherQueue(const std::vector<int>& resourceIDs);
 
     void clearTasks() {
+        cancelPathRequest();
         taskQueue_.clear();
         m_HasTarget = false;
-        state_ = UnitState::IDLE;
-        targetID_ = -1;
+        m_Flow.reset();
+        state() = UnitState::IDLE;
+        targetUnit_ = UnitHandle();
         attackQueue_.clear();
-        targetBuilding_ = nullptr;
+        targetBuilding_ = BuildingHandle();
     }
 
     // Combat Logic
     void assignAttackTask(Unit* enemy);
+    // Queues the enemies to fight (the closest MAX_ATTACK_TARGETS if there are more)
     void assignAttackQueue(const std::vector<Unit*>& enemies);
     float repathTimer_ = 0.0f;
 
@@ -62,52 +111,118 @@ public:
     void assignAttackTask(Building* building);
 
     void takeDamage(int dmg);
-    bool isDead() const { return currentHealth_ <= 0; }
-    int getTeam() const { return teamID_; }
-    bool isAttacking() const { return state_ == UnitState::ATTACKING; }
-    bool isAttackingBuilding() const { return state_ == UnitState::ATTACKING_BUILDING; }
-    bool isGathering() const { return state_ == UnitState::GATHERING; }
-    void explode() { currentHealth_ = -1.0f; } // Instantly kill unit
+    // Main thread, after the updates: land the tick's attacks on every unit at once
+    static void resolveCombat(CombatLog& combat);
+    bool isDead() const { return health() <= 0; }
+    int getTeam() const { return team(); }
+    bool isAttacking() const { return state() == UnitState::ATTACKING; }
+    bool isAttackingBuilding() const { return state() == UnitState::ATTACKING_BUILDING; }
+    bool isGathering() const { return state() == UnitState::GATHERING; }
+    // Doing something that needs an update every tick; the rest can wait (see UpdateScheduler)
+    bool isBusy() const;
+    void explode() { health() = -1; } // Instantly kill unit
 
     int getID() const { return id_; }
-    UnitState getState() const { return state_; }
+    // Hot state of every live unit, for loops that only need positions, states and the like
+    static const UnitStore& store() { return Store; }
+    // Our index into store() (changes as other units come and go)
+    int getSlot() const { return slot_; }
+    // Main thread, before the tick's updates: freeze every unit's position for the others to read
+    static void beginTick() { Store.beginTick(); }
+    // Handle that stays safe to hold after we die (resolves to nullptr then)
+    UnitHandle getHandle() const { return handle_; }
+    static Unit* resolve(UnitHandle h) { return Handles.get(h); }
+    UnitState getState() const { return state(); }
 
 private:
     static int NextID;
     int id_;
 
+    // Every live unit, so targets resolve in O(1) instead of a scan over all units
+    static HandleTable<Unit> Handles;
+    UnitHandle handle_;
+
+    static ObjectPool<Unit> Pool;
+
+    // Hot state lives in the shared store, see UnitStore.h
+    static UnitStore Store;
+    int slot_;
+
+    glm::vec3& position() { return Store.position[slot_]; }
+    const glm::vec3& position() const { return Store.position[slot_]; }
+    glm::vec3& velocity() { return Store.velocity[slot_]; }
+    const glm::vec3& velocity() const { return Store.velocity[slot_]; }
+    glm::vec3& steering() { return Store.steering[slot_]; }
+    UnitState& state() { return Store.state[slot_]; }
+    UnitState state() const { return Store.state[slot_]; }
+    int& health() { return Store.health[slot_]; }
+    int health() const { return Store.health[slot_]; }
+    uint8_t& selected() { return Store.selected[slot_]; }
+    uint8_t selected() const { return Store.selected[slot_]; }
+    UnitType type() const { return Store.type[slot_]; }
+    int team() const { return Store.team[slot_]; }
+
     // Combat Variables
-    int targetID_ = -1;
-    std::deque<int> attackQueue_;
+    UnitHandle targetUnit_;
+    FixedQueue<UnitHandle, MAX_ATTACK_TARGETS> attackQueue_;  // Unordered: the closest one left is taken next
+    float acquireTimer_ = 0.0f;
 
-    // Declare the Building Target Pointer
-    Building* targetBuilding_ = nullptr;
+    // Soldiers only: take on an enemy in sight when idle, or when our target is out of sight
+    void acquireTarget(float dt, const TeamSpatialIndex& hostiles);
+    // Pick the next target from attackQueue_ (false, and no target, when it has nobody left)
+    bool takeNextQueuedTarget();
 
-    // Standard Variables
-    UnitType type_;
-    int teamID_;
+    // Building Target
+    BuildingHandle targetBuilding_;
 
-    glm::vec3 position_;
-    glm::vec3 velocity_;
+    // Standard Variables
     SkinnedMesh* mesh_;
-    bool selected_ = false;
 
-    // Movement Path
-    std::vector<glm::vec3> m_Path;
+    // Movement Path (corner waypoints, possibly shared with other units)
+    PathCursor m_Path;
     bool m_HasTarget = false;
 
-    // State
-    UnitState state_ = UnitState::IDLE;
+    // Flow Field (used instead of m_Path while set)
+    std::shared_ptr<const FlowField> m_Flow;
+    glm::vec3 m_FlowSlot = glm::vec3(0.0f);
+    uint64_t m_FlowVersion = 0;         // Grid version our way down m_Flow was last checked against
+
+    // Cooperative move (steps reserved against the rest of the group, see CooperativePathfinder.h)
+    std::shared_ptr<CooperativeGroup> m_Group;
+    int m_GroupMember = -1;
+
+    // Path Requests (answered later when a PathRequestService is active)
+    // MOVE = player order, REROUTE = new route to where we were already heading
+    enum class PathPurpose { NONE, GATHER, CHASE, MOVE, REROUTE };
+    int m_PathTicket = 0;
+    PathPurpose m_PathPurpose = PathPurpose::NONE;
+    bool m_SubmitPending = false;       // requestPath() ran, submitPathRequest() has not yet
+    glm::vec3 m_RequestStart = glm::vec3(0.0f);
+    glm::vec3 m_RequestTarget = glm::vec3(0.0f);
+    uint64_t m_RequestVersion = 0;
+
+    // Keeps our chase path between repaths, so following a moving target only repairs it
+    std::shared_ptr<ChasePlanner> m_ChasePlanner;
+
+    // What the current m_Path was searched for, and on which grid version
+    glm::vec3 m_PathGoal = glm::vec3(0.0f);
+    uint64_t m_PathVersion = 0;
+
+    void requestPath(const glm::vec3& target, PathPurpose purpose);
+    bool isPathRequested() const { return m_PathTicket != 0 || m_SubmitPending; }
+    void receivePath(const std::shared_ptr<const WaypointPath>& path, PathPurpose purpose);
+    void cancelPathRequest();
+    bool isPathAffected(const NavigationGrid* navGrid);
+    bool isFlowAffected(const NavigationGrid* navGrid);
 
     // Worker Stats
     float currentStamina_ = 100.0f;
-    std::deque<int> taskQueue_;
+    FixedQueue<int, MAX_TASKS> taskQueue_;
     int currentTargetID_ = -1;
     float gatherTimer_ = 0.0f;
 
     // Combat Stats
     int maxHealth_;
-    int currentHealth_;
     int damage_;
     float attackRange_;
     float attackCooldown_;
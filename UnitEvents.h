@@ -0,0 +1,115 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Unit.h"
+#include "Building.h"
+#include "Environment.h"
+#include "Resource.h"
+#include "NavigationGrid.h"
+#include "PathCache.h"
+#include "WaypointPath.h"
+#include "CombatEvents.h"
+
+// Side effects of a slice of the unit update, kept in the order they happened.
+// Unit::update may run on several threads at once, so it never changes anything
+// outside its own unit: attacks, resource gains, chopped trees (and the grid cells
+// they free) and path cache stores are recorded here and applied afterwards on the
+// main thread. Applying the slices in unit order gives the same game state whatever
+// the number of threads.
+class UnitEvents {
+public:
+    // A hit on a unit or a building, landed later with everyone else's (see CombatLog)
+    void attack(UnitHandle attacker, UnitHandle target, int damage, bool ranged, const glm::vec3& from, const glm::vec3& to) {
+        m_Attacks.push_back(makeAttack(attacker, damage, ranged, from, to));
+        m_Attacks.back().target = target;
+    }
+
+    void attack(UnitHandle attacker, BuildingHandle target, int damage, bool ranged, const glm::vec3& from, const glm::vec3& to) {
+        m_Attacks.push_back(makeAttack(attacker, damage, ranged, from, to));
+        m_Attacks.back().building = target;
+    }
+
+    // Worker took `amount` from an obstacle; it goes to the player's stock
+    void gather(int obstacleID, int amount) {
+        Event e(Type::GATHER);
+        e.id = obstacleID;
+        e.amount = (float)amount;
+        m_Events.push_back(e);
+    }
+
+    void storePath(const glm::vec3& start, const glm::vec3& target, const std::shared_ptr<const WaypointPath>& path, uint64_t version) {
+        Event e(Type::STORE_PATH);
+        e.from = start;
+        e.to = target;
+        e.path = path;
+        e.version = version;
+        m_Events.push_back(e);
+    }
+
+    bool empty() const { return m_Events.empty() && m_Attacks.empty(); }
+    size_t size() const { return m_Events.size() + m_Attacks.size(); }
+    void clear() {
+        m_Events.clear();
+        m_Attacks.clear();
+    }
+
+    // Main thread, after the update slices are done: attacks join the tick's combat
+    // stream (resolved once every slice is in), the rest takes effect here
+    void apply(Resources& resources, Environment* env, NavigationGrid* navGrid, CombatLog& combat) {
+        combat.append(m_Attacks);
+        m_Attacks.clear();
+
+        PathCache* cache = PathCache::getActive();
+        for (const Event& e : m_Events) {
+            switch (e.type) {
+            case Type::GATHER: {
+                // Another worker may have taken the last of it earlier this tick
+                Obstacle* target = env ? env->getObstacleById(e.id) : nullptr;
+                if (!target || !target->active) break;
+                target->resourceAmount -= (int)e.amount;
+                if (target->type == ObstacleType::TREE) resources.addWood((int)e.amount);
+                else resources.addRock((int)e.amount);
+
+                if (target->resourceAmount <= 0) {
+                    target->active = false;
+                    if (navGrid) navGrid->updateArea(target->position, target->radius, false);
+                }
+                break;
+            }
+            case Type::STORE_PATH:
+                if (cache) cache->store(e.from, e.to, e.path, e.version);
+                break;
+            }
+        }
+        m_Events.clear();
+    }
+
+private:
+    enum class Type { GATHER, STORE_PATH };
+
+    struct Event {
+        explicit Event(Type t) : type(t) {}
+        Type type;
+        int id = -1;
+        float amount = 0.0f;
+        glm::vec3 from = glm::vec3(0.0f), to = glm::vec3(0.0f);
+        std::shared_ptr<const WaypointPath> path;
+        uint64_t version = 0;
+    };
+
+    std::vector<Event> m_Events;
+    std::vector<CombatEvent> m_Attacks;
+
+    static CombatEvent makeAttack(UnitHandle attacker, int damage, bool ranged, const glm::vec3& from, const glm::vec3& to) {
+        CombatEvent e;
+        e.type = CombatEvent::Type::ATTACK;
+        e.attacker = attacker;
+        e.amount = damage;
+        e.ranged = ranged;
+        e.from = from;
+        e.to = to;
+        return e;
+    }
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class Unit;
+
+enum class UnitType { WORKER, MELEE, RANGED };
+enum class UnitState { IDLE, MOVING, GATHERING, ATTACKING, ATTACKING_BUILDING };
+
+// Hot per-unit state as parallel arrays (struct of arrays), one dense slot per live
+// unit. The loops that touch every unit every frame (rendering batches, snow trails,
+// selection, the spatial hash) read only what they need from these arrays instead
+// of hopping between heap objects that also carry queues, paths and planners.
+// The rest of a unit (its cold state) stays in the Unit object, which finds its
+// hot state through its slot. Slots are packed: removing a unit moves the last
+// one into the hole, so handles (UnitHandle) are what stays stable, not slots.
+class UnitStore {
+public:
+    // --- Components, entries [0, size()) are live ---
+    std::vector<glm::vec3> position;
+    std::vector<glm::vec3> prevPosition; // Position at the start of the latest tick
+    std::vector<glm::vec3> velocity;
+    std::vector<glm::vec3> steering;     // Forces summed by this tick's update, integrated afterwards
+    std::vector<UnitState> state;
+    std::vector<UnitType> type;
+    std::vector<int> team;
+    std::vector<int> health;
+    std::vector<uint8_t> selected;
+    std::vector<Unit*> owner;         // Unit object owning each slot
+
+    size_t size() const { return owner.size(); }
+
+    // Start of a tick: freeze where everyone is, for the units that look at each other
+    void beginTick() { prevPosition = position; }
+
+    // Where to draw a unit `alpha` of the way from the previous tick to the latest one
+    glm::vec3 renderPosition(size_t slot, float alpha) const {
+        return prevPosition[slot] + (position[slot] - prevPosition[slot]) * alpha;
+    }
+
+    int add(Unit* unit, UnitType unitType, const glm::vec3& pos, int teamID, int hp) {
+        position.push_back(pos);
+        prevPosition.push_back(pos);
+        velocity.push_back(glm::vec3(0.0f));
+        steering.push_back(glm::vec3(0.0f));
+        state.push_back(UnitState::IDLE);
+        type.push_back(unitType);
+        team.push_back(teamID);
+        health.push_back(hp);
+        selected.push_back(0);
+        owner.push_back(unit);
+        return (int)owner.size() - 1;
+    }
+
+    // Returns the unit that was moved into `slot` (its slot is now `slot`), nullptr if none
+    Unit* remove(int slot) {
+        int last = (int)owner.size() - 1;
+        Unit* moved = nullptr;
+        if (slot != last) {
+            position[slot] = position[last];
+            prevPosition[slot] = prevPosition[last];
+            velocity[slot] = velocity[last];
+            steering[slot] = steering[last];
+            state[slot] = state[last];
+            type[slot] = type[last];
+            team[slot] = team[last];
+            health[slot] = health[last];
+            selected[slot] = selected[last];
+            owner[slot] = owner[last];
+            moved = owner[slot];
+        }
+        position.pop_back();
+        prevPosition.pop_back();
+        velocity.pop_back();
+        steering.pop_back();
+        state.pop_back();
+        type.pop_back();
+        team.pop_back();
+        health.pop_back();
+        selected.pop_back();
+        owner.pop_back();
+        return moved;
+    }
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Unit.h"
+#include "SpatialHash.h"
+
+// Simulation level of detail: decides which units run their FSM this tick.
+// Units that are doing something (moving, fighting, waiting on a path, about to start
+// a queued task, selected) or that have an enemy close by update every
+// tick. The rest (standing idle, or chopping at a tree) are quiet: on screen they
+// update every 2nd tick, off screen every 4th, staggered so each tick gets an even
+// share. A skipped unit keeps its time, and its next update gets all of it, so timers
+// such as chopping run at the same speed.
+// Movement is not scheduled: Unit::integrateMovement still moves every unit every
+// tick. A quiet unit has no velocity, and its last steering force was too weak to
+// move it, so it stands still while it waits.
+class UpdateScheduler {
+public:
+    enum Bucket { ACTIVE, VISIBLE, HIDDEN, BUCKET_COUNT };
+    enum { VISIBLE_PERIOD = 2, HIDDEN_PERIOD = 4 };  // Ticks between updates of quiet units
+
+    struct Due {
+        Unit* unit;
+        float dt;                    // Time since this unit's last update
+    };
+
+    struct Stats {
+        int units[BUCKET_COUNT] = {}; // Units per bucket (as of their last classification)
+        int updated = 0;              // Updates run this tick
+        int skipped = 0;              // ... and skipped
+    };
+
+    void setEnabled(bool enabled) { m_Enabled = enabled; }
+    bool isEnabled() const { return m_Enabled; }
+
+    // Fill `due` with the units to update this tick, in unit order.
+    // isVisible(position) says whether a point is on screen.
+    template <class VisibleFn>
+    void schedule(const std::vector<std::unique_ptr<Unit>>& units, float dt, const SpatialHash& neighbors,
+                  VisibleFn isVisible, std::vector<Due>& due) {
+        due.clear();
+        m_Tick++;
+        m_Stats = Stats();
+
+        for (const auto& u : units) {
+            Unit* unit = u.get();
+            Entry& entry = entryOf(unit->getHandle());
+            entry.pendingDt += dt;
+
+            // Reclassify when the unit is due anyway; the cheap checks run every tick so
+            // a new order or a push wakes a quiet unit right away
+            if (!m_Enabled || unit->isBusy()) entry.bucket = ACTIVE;
+            if (entry.bucket != ACTIVE && !isTurn(entry.bucket, unit->getHandle().index)) {
+                m_Stats.units[entry.bucket]++;
+                m_Stats.skipped++;
+                continue;
+            }
+
+            if (m_Enabled && !unit->isBusy()) entry.bucket = classifyQuiet(unit, neighbors, isVisible);
+            m_Stats.units[entry.bucket]++;
+            m_Stats.updated++;
+
+            Due d;
+            d.unit = unit;
+            d.dt = entry.pendingDt;
+            due.push_back(d);
+            entry.pendingDt = 0.0f;
+        }
+        m_TotalUpdated += m_Stats.updated;
+        m_TotalSkipped += m_Stats.skipped;
+    }
+
+    // How long this tick's updates took: skipped updates are counted as saving the
+    // average cost of the ones that ran
+    void recordUpdateTime(double ms) {
+        if (m_Stats.updated > 0) m_SavedMs += ms * m_Stats.skipped / m_Stats.updated;
+    }
+
+    const Stats& getStats() const { return m_Stats; }
+    uint64_t getTotalUpdated() const { return m_TotalUpdated; }
+    uint64_t getTotalSkipped() const { return m_TotalSkipped; }
+    double getSavedMs() const { return m_SavedMs; }
+    void resetTotals() {
+        m_TotalUpdated = 0;
+        m_TotalSkipped = 0;
+        m_SavedMs = 0.0;
+    }
+
+private:
+    // Per unit, by handle slot (the generation tells a new unit from the slot's last owner)
+    struct Entry {
+        uint32_t generation = 0;
+        float pendingDt = 0.0f;
+        Bucket bucket = ACTIVE;
+    };
+
+    std::vector<Entry> m_Entries;
+    uint64_t m_Tick = 0;
+    bool m_Enabled = true;
+
+    Stats m_Stats;
+    uint64_t m_TotalUpdated = 0;
+    uint64_t m_TotalSkipped = 0;
+    double m_SavedMs = 0.0;
+
+    Entry& entryOf(UnitHandle h) {
+        if (h.index >= m_Entries.size()) m_Entries.resize(h.index + 1);
+        Entry& entry = m_Entries[h.index];
+        if (entry.generation != h.generation) {
+            entry = Entry();
+            entry.generation = h.generation;
+        }
+        return entry;
+    }
+
+    // Staggered by handle slot, so the quiet units of a bucket spread over its period
+    bool isTurn(Bucket bucket, uint32_t index) const {
+        int period = (bucket == VISIBLE) ? VISIBLE_PERIOD : HIDDEN_PERIOD;
+        return (m_Tick + index) % period == 0;
+    }
+
+    template <class VisibleFn>
+    static Bucket classifyQuiet(const Unit* unit, const SpatialHash& neighbors, VisibleFn& isVisible) {
+        glm::vec3 pos = unit->getPosition();
+        if (neighbors.isEnemyNear(pos, unit->getTeam())) return ACTIVE; // Within 32-64 m
+        return isVisible(pos) ? VISIBLE : HIDDEN;
+    }
+};
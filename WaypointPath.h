@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// A finished path stored compactly: one corner cell per waypoint, 4 bytes each
+// instead of a vec3. Never modified after it is built, so every unit that gets
+// the same path (PathCache hits) shares one copy through a shared_ptr and walks
+// it with its own PathCursor.
+class WaypointPath {
+public:
+    explicit WaypointPath(const std::vector<glm::vec3>& points) {
+        m_Points.reserve(points.size());
+        for (const auto& p : points) m_Points.push_back({ (int16_t)p.x, (int16_t)p.z });
+    }
+
+    size_t size() const { return m_Points.size(); }
+    bool empty() const { return m_Points.empty(); }
+    // Centre of the i-th corner cell: the straight line between two centres is
+    // exactly what Pathfinder::hasLineOfSight checked
+    glm::vec3 operator[](size_t i) const { return glm::vec3(m_Points[i].x + 0.5f, 0.0f, m_Points[i].z + 0.5f); }
+    glm::vec3 back() const { return (*this)[m_Points.size() - 1]; }
+
+private:
+    struct Point { int16_t x, z; };
+    std::vector<Point> m_Points;
+};
+
+// One unit's progress along a shared WaypointPath. Reaching a waypoint moves the
+// cursor instead of erasing from the front of a vector.
+class PathCursor {
+public:
+    PathCursor() {}
+    explicit PathCursor(std::shared_ptr<const WaypointPath> path) : m_Path(std::move(path)) {}
+
+    bool empty() const { return !m_Path || m_Next >= m_Path->size(); }
+    size_t remaining() const { return empty() ? 0 : m_Path->size() - m_Next; }
+
+    // Waypoint we are heading for, the i-th one after it, and the last one
+    glm::vec3 front() const { return (*m_Path)[m_Next]; }
+    glm::vec3 ahead(size_t i) const { return (*m_Path)[m_Next + i]; }
+    glm::vec3 back() const { return m_Path->back(); }
+
+    void advance() { m_Next++; }
+    void clear() { m_Path.reset(); m_Next = 0; }
+
+private:
+    std::shared_ptr<const WaypointPath> m_Path;
+    size_t m_Next = 0;
+};
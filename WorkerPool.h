@@ -0,0 +1,106 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+// Fixed set of threads for splitting one frame's work into numbered tasks.
+// run() hands the tasks out one at a time (the calling thread works too) and
+// returns once all of them are finished, so the caller never sees a half-done frame.
+// Which thread runs which task is up to timing; callers that need the same result
+// every time give each task its own output and combine them in task order.
+class WorkerPool {
+public:
+    // `threads` extra threads besides the caller, 0 = everything runs on the caller
+    explicit WorkerPool(int threads) {
+        for (int i = 0; i < threads; i++) m_Threads.emplace_back([this]() { workerLoop(); });
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_Wake.notify_all();
+        for (auto& t : m_Threads) t.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int getThreadCount() const { return (int)m_Threads.size() + 1; }
+
+    // Run task(i) for every i in [0, count)
+    void run(int count, const std::function<void(int)>& task) {
+        if (count <= 0) return;
+        if (m_Threads.empty() || count == 1) {
+            for (int i = 0; i < count; i++) task(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Task = &task;
+            m_Count = count;
+            m_Next = 0;
+            m_Pending = count;
+            m_Generation++;
+        }
+        m_Wake.notify_all();
+
+        work();
+
+        // Every task done and every worker out of work(), so the next run starts clean
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Done.wait(lock, [this]() { return m_Pending == 0 && m_Active == 0; });
+        m_Task = nullptr;
+    }
+
+private:
+    std::vector<std::thread> m_Threads;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Done;
+    bool m_Stopping = false;
+    uint64_t m_Generation = 0;        // Bumped by every run()
+    int m_Active = 0;                 // Workers inside work()
+
+    const std::function<void(int)>* m_Task = nullptr;
+    int m_Count = 0;
+    std::atomic<int> m_Next{ 0 };
+    std::atomic<int> m_Pending{ 0 };
+
+    void work() {
+        for (;;) {
+            int i = m_Next.fetch_add(1);
+            if (i >= m_Count) return;
+            (*m_Task)(i);
+            if (m_Pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Done.notify_all();
+            }
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Wake.wait(lock, [&]() { return m_Stopping || (m_Task && m_Generation != seen); });
+                if (m_Stopping) return;
+                seen = m_Generation;
+                m_Active++;
+            }
+            work();
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Active--;
+            }
+            m_Done.notify_all();
+        }
+    }
+};
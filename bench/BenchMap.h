@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdlib>
+#include <vector>
+#include <utility>
+#include <glm/glm.hpp>
+
+// The map the game bakes in Environment::initialize and createContext(), rebuilt
+// without any rendering: map border, 1500 rocks and trees kept clear of both
+// bases, the two town centers and the first resource. Works on any grid class
+// with updateArea/isBlocked, so the baseline copies bake the same map.
+template <class Grid>
+inline void bakeMap(Grid& grid, unsigned seed = 1234) {
+    srand(seed);
+    auto randomFloat = [](float a, float b) { return a + (float)rand() / ((float)RAND_MAX / (b - a)); };
+    const float mapSize = 512.0f, edge = 30.0f;
+    for (float x = 0; x <= mapSize; x += 15)
+        for (float z = 0; z <= mapSize; z += 15)
+            if (x < edge || x > mapSize - edge || z < edge || z > mapSize - edge)
+                grid.updateArea(glm::vec3(x, 0, z), randomFloat(10, 20), true);
+
+    for (int i = 0; i < 1500; ++i) {
+        float x = randomFloat(edge, mapSize - edge), z = randomFloat(edge, mapSize - edge);
+        if (grid.isBlocked((int)x, (int)z)) continue;
+        if (glm::distance(glm::vec2(x, z), glm::vec2(50, 50)) < 80) continue;
+        if (glm::distance(glm::vec2(x, z), glm::vec2(462, 462)) < 80) continue;
+        float radius = (randomFloat(0, 1) > 0.3f) ? 5.0f : 4.0f;
+        grid.updateArea(glm::vec3(x, 0, z), radius + 0.5f, true);
+    }
+    grid.updateArea(glm::vec3(50, 0, 50), 12, true);
+    grid.updateArea(glm::vec3(460, 0, 460), 12, true);
+    grid.updateArea(glm::vec3(50, 0, 120), 8, true);
+
+    // Seal the strip outside the playable border cell by cell
+    for (int x = 0; x < 512; x++)
+        for (int z = 0; z < 512; z++)
+            if (x < 30 || x >= 482 || z < 30 || z >= 482) grid.updateArea(glm::vec3(x, 0, z), 0.5f, true);
+}
+
+// Random start/target pairs inside the border (starts on open cells, targets anywhere)
+template <class Grid>
+inline std::vector<std::pair<glm::vec3, glm::vec3>> makeQueries(const Grid& grid, int count, unsigned seed = 99) {
+    srand(seed);
+    std::vector<std::pair<glm::vec3, glm::vec3>> queries;
+    while ((int)queries.size() < count) {
+        float sx = 40.0f + rand() % 430, sz = 40.0f + rand() % 430;
+        float tx = 40.0f + rand() % 430, tz = 40.0f + rand() % 430;
+        if (grid.isBlocked((int)sx, (int)sz)) continue;
+        queries.push_back({ glm::vec3(sx, 0, sz), glm::vec3(tx, 0, tz) });
+    }
+    return queries;
+}
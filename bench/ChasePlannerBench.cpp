@@ -0,0 +1,149 @@
+// 200 chasers after 200 random-walking targets, 20 repaths each: a fresh A*
+// search every time against one ChasePlanner per chaser. Both runs see the same
+// target motion; each chaser walks 2.5 cells along its path between repaths.
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include "../Pathfinder.h"
+#include "../ChasePlanner.h"
+#include "BenchMap.h"
+
+typedef std::chrono::steady_clock Clock;
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static double pathLength(glm::vec3 start, const std::vector<glm::vec3>& path) {
+    double length = 0;
+    glm::vec3 from((int)start.x, 0, (int)start.z);
+    for (const glm::vec3& p : path) {
+        length += glm::distance(from, p);
+        from = p;
+    }
+    return length;
+}
+
+// Position after moving `dist` along the path (cell centres)
+static glm::vec3 walk(glm::vec3 pos, const std::vector<glm::vec3>& path, float dist) {
+    for (const glm::vec3& p : path) {
+        glm::vec3 centre = p + glm::vec3(0.5f, 0, 0.5f);
+        float length = glm::distance(pos, centre);
+        if (length >= dist) return pos + (centre - pos) * (dist / length);
+        dist -= length;
+        pos = centre;
+    }
+    return pos;
+}
+
+struct Chase {
+    std::vector<glm::vec3> chasers, targets;
+    std::vector<glm::vec2> headings;
+};
+
+// Every target turns a little and steps 2 cells, bouncing off rocks and the border
+static void moveTargets(Chase& c, const NavigationGrid& grid, unsigned& seed) {
+    for (size_t i = 0; i < c.targets.size(); i++) {
+        seed = seed * 1103515245u + 12345u;
+        float turn = ((int)((seed >> 16) % 100) - 50) / 100.0f;
+        float angle = atan2(c.headings[i].y, c.headings[i].x) + turn;
+        c.headings[i] = glm::vec2(cos(angle), sin(angle));
+        glm::vec3 next = c.targets[i] + glm::vec3(c.headings[i].x, 0, c.headings[i].y) * 2.0f;
+        glm::vec3 cur = c.targets[i];
+        if (next.x > 40 && next.x < 470 && next.z > 40 && next.z < 470 && !grid.isBlocked((int)next.x, (int)next.z)
+            && grid.getRegion((int)next.x, (int)next.z) == grid.getRegion((int)cur.x, (int)cur.z))
+            c.targets[i] = next;
+        else
+            c.headings[i] *= -1.0f;
+    }
+}
+
+int main() {
+    NavigationGrid grid(512, 512);
+    bakeMap(grid);
+    Pathfinder::setMode(PathMode::ASTAR);
+    const int CHASERS = 200, ROUNDS = 20;
+
+    // Each chaser starts 30-80 cells from its target, in the same region
+    Chase start;
+    srand(11);
+    while ((int)start.chasers.size() < CHASERS) {
+        glm::vec3 c(60.0f + rand() % 390, 0, 60.0f + rand() % 390);
+        float angle = (rand() % 628) / 100.0f, radius = 30.0f + rand() % 50;
+        glm::vec3 t = c + glm::vec3(radius * cos(angle), 0, radius * sin(angle));
+        if (t.x < 40 || t.x > 470 || t.z < 40 || t.z > 470) continue;
+        if (grid.isBlocked((int)c.x, (int)c.z) || grid.isBlocked((int)t.x, (int)t.z)) continue;
+        if (grid.getRegion((int)c.x, (int)c.z) != grid.getRegion((int)t.x, (int)t.z)) continue;
+        start.chasers.push_back(c);
+        start.targets.push_back(t);
+        start.headings.push_back(glm::vec2(cos(angle), sin(angle)));
+    }
+
+    double freshMs = 0, freshWorst = 0, freshLength = 0;
+    long freshExpanded = 0;
+    int freshFailed = 0;
+    {
+        Chase c = start;
+        unsigned seed = 5;
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < CHASERS; i++) {
+                Clock::time_point t = Clock::now();
+                std::vector<glm::vec3> path = Pathfinder::findPath(c.chasers[i], c.targets[i], &grid);
+                double ms = msSince(t);
+                freshMs += ms;
+                freshWorst = std::max(freshWorst, ms);
+                freshExpanded += Pathfinder::lastStats().nodesExpanded;
+                if (path.empty()) { freshFailed++; continue; }
+                freshLength += pathLength(c.chasers[i], path);
+                c.chasers[i] = walk(c.chasers[i], path, 2.5f);
+            }
+            moveTargets(c, grid, seed);
+        }
+    }
+
+    std::vector<std::unique_ptr<ChasePlanner>> planners;
+    for (int i = 0; i < CHASERS; i++) planners.emplace_back(new ChasePlanner());
+    double plannerMs = 0, firstMs = 0, repairMs = 0, plannerWorst = 0, plannerLength = 0;
+    long plannerExpanded = 0, firstExpanded = 0, repairExpanded = 0;
+    int plannerFailed = 0, repairs = 0;
+    {
+        Chase c = start;
+        unsigned seed = 5;
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < CHASERS; i++) {
+                Clock::time_point t = Clock::now();
+                std::vector<glm::vec3> path = planners[i]->findPath(c.chasers[i], c.targets[i], &grid);
+                double ms = msSince(t);
+                plannerMs += ms;
+                plannerExpanded += planners[i]->getLastExpanded();
+                if (r == 0) {
+                    firstMs += ms;
+                    firstExpanded += planners[i]->getLastExpanded();
+                }
+                else {
+                    plannerWorst = std::max(plannerWorst, ms);
+                }
+                if (planners[i]->wasLastRepaired()) {
+                    repairs++;
+                    repairMs += ms;
+                    repairExpanded += planners[i]->getLastExpanded();
+                }
+                if (path.empty()) { plannerFailed++; continue; }
+                plannerLength += pathLength(c.chasers[i], path);
+                c.chasers[i] = walk(c.chasers[i], path, 2.5f);
+            }
+            moveTargets(c, grid, seed);
+        }
+    }
+
+    int calls = CHASERS * ROUNDS, laterCalls = CHASERS * (ROUNDS - 1);
+    printf("%d chasers x %d repaths\n", CHASERS, ROUNDS);
+    printf("fresh A*: %.1f ms total, %.3f ms avg, worst %.2f ms, %ld expansions, %d failed, path length %.0f\n",
+        freshMs, freshMs / calls, freshWorst, freshExpanded, freshFailed, freshLength);
+    printf("planner : %.1f ms total (first searches %.1f ms / %ld expansions), later calls avg %.3f ms, worst %.2f ms, %ld expansions, %d failed, path length %.0f\n",
+        plannerMs, firstMs, firstExpanded, (plannerMs - firstMs) / laterCalls, plannerWorst, plannerExpanded, plannerFailed, plannerLength);
+    if (repairs > 0)
+        printf("repairs: %d of %d calls, avg %.4f ms, avg %.1f expansions\n", repairs, calls, repairMs / repairs, (double)repairExpanded / repairs);
+    printf("expansions per later call %.0f vs fresh A* %.0f\n",
+        (double)(plannerExpanded - firstExpanded) / laterCalls, (double)freshExpanded / calls);
+    return 0;
+}
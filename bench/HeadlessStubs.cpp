@@ -0,0 +1,26 @@
+// Render-side symbols Unit.cpp links against, as no-ops, so a benchmark can run
+// real unit updates without a window, GL context or model files. Link this in
+// place of SkinnedMesh.cpp, Terrain.cpp, Building.cpp, the particle emitters and
+// project-rts.cpp. Nothing here is reached unless a unit draws, is hit by a mage
+// or attacks a building.
+#include "../SkinnedMesh.h"
+#include "../Terrain.h"
+#include "../Building.h"
+#include "../ParticleManager.h"
+
+SkinnedMesh::SkinnedMesh(const std::string&) {}
+void SkinnedMesh::SetupInstancing() {}
+void SkinnedMesh::UpdateAnimation(float) {}
+void SkinnedMesh::Draw(GLuint) {}
+
+glm::vec3 Terrain::getHeightAt(float x, float z) const { return glm::vec3(x, 0.0f, z); }
+
+HandleTable<Building> Building::Handles;
+void Building::takeDamage(float) {}
+
+std::vector<std::unique_ptr<IntParticleEmitter>> ParticleManager::active_emitters;
+Drawable* ParticleManager::particle_quad = nullptr;
+IntParticleEmitter::IntParticleEmitter(Drawable*, int number) : number_of_particles(number) {}
+FountainEmitter::FountainEmitter(Drawable* model, int number) : IntParticleEmitter(model, number) {}
+void FountainEmitter::createNewParticle(int) {}
+void FountainEmitter::updateParticles(float, float, glm::vec3) {}
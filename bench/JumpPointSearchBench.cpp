@@ -0,0 +1,65 @@
+// A* against Jump Point Search on the same 800 queries: time, node expansions,
+// paths found and total path cost, then the same figures over only the queries
+// both modes solve.
+#include <chrono>
+#include <cstdio>
+#include "../Pathfinder.h"
+#include "BenchMap.h"
+
+// Octile cost of a corner path (diagonal steps cost 1.414)
+static double pathCost(const std::vector<glm::vec3>& path, glm::vec3 start) {
+    double cost = 0;
+    glm::vec3 prev((int)start.x, 0, (int)start.z);
+    for (const glm::vec3& p : path) {
+        float dx = std::abs(p.x - prev.x), dz = std::abs(p.z - prev.z);
+        cost += std::max(dx, dz) + 0.414 * std::min(dx, dz);
+        prev = p;
+    }
+    return cost;
+}
+
+int main() {
+    NavigationGrid grid(512, 512);
+    bakeMap(grid);
+    std::vector<std::pair<glm::vec3, glm::vec3>> queries = makeQueries(grid, 800);
+
+    typedef std::chrono::steady_clock Clock;
+    for (PathMode mode : { PathMode::ASTAR, PathMode::JPS, PathMode::ASTAR, PathMode::JPS }) {
+        Pathfinder::setMode(mode);
+        long expanded = 0;
+        int found = 0;
+        double cost = 0;
+        Clock::time_point t0 = Clock::now();
+        for (auto& q : queries) {
+            std::vector<glm::vec3> path = Pathfinder::findPath(q.first, q.second, &grid);
+            expanded += Pathfinder::lastStats().nodesExpanded;
+            if (path.empty()) continue;
+            found++;
+            cost += pathCost(path, q.first);
+        }
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        printf("%-4s %7.1f ms  expansions %8ld  found %d/%zu  total cost %.0f\n",
+            Pathfinder::getModeName(mode), ms, expanded, found, queries.size(), cost);
+    }
+
+    int both = 0;
+    double costAStar = 0, costJps = 0;
+    long expandedAStar = 0, expandedJps = 0;
+    for (auto& q : queries) {
+        Pathfinder::setMode(PathMode::ASTAR);
+        std::vector<glm::vec3> a = Pathfinder::findPath(q.first, q.second, &grid);
+        int aExpanded = Pathfinder::lastStats().nodesExpanded;
+        Pathfinder::setMode(PathMode::JPS);
+        std::vector<glm::vec3> j = Pathfinder::findPath(q.first, q.second, &grid);
+        int jExpanded = Pathfinder::lastStats().nodesExpanded;
+        if (a.empty() || j.empty()) continue;
+        both++;
+        costAStar += pathCost(a, q.first);
+        costJps += pathCost(j, q.first);
+        expandedAStar += aExpanded;
+        expandedJps += jExpanded;
+    }
+    printf("both solved %d: cost A* %.0f JPS %.0f, expansions A* %ld JPS %ld\n",
+        both, costAStar, costJps, expandedAStar, expandedJps);
+    return 0;
+}
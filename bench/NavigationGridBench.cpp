@@ -0,0 +1,119 @@
+// The baseline vector<bool> NavigationGrid against the bit-packed one: stamping,
+// random lookups, the building placement check and the 11x11 clearance square.
+// Every section also checks that both grids give the same answers.
+#include <vector>
+#include <iostream>
+#include <functional>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <cstdio>
+#include <glm/glm.hpp>
+namespace baseline {
+#include "baseline/NavigationGrid.h"
+}
+#include "../NavigationGrid.h"
+
+typedef std::chrono::steady_clock Clock;
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main() {
+    baseline::NavigationGrid oldGrid(512, 512);
+    NavigationGrid grid(512, 512);
+    srand(5);
+
+    // Stamping: 5000 circles of every size, some hanging off the map, then 1000 clears
+    std::vector<std::pair<glm::vec3, float>> stamps;
+    for (int i = 0; i < 5000; i++)
+        stamps.push_back({ glm::vec3(rand() % 560 - 24 + 0.3f, 0, rand() % 560 - 24 + 0.7f), 0.5f + (rand() % 300) / 20.0f });
+    Clock::time_point t = Clock::now();
+    for (auto& s : stamps) oldGrid.updateArea(s.first, s.second, true);
+    double oldMs = msSince(t);
+    t = Clock::now();
+    for (auto& s : stamps) grid.updateArea(s.first, s.second, true);
+    double newMs = msSince(t);
+    for (int i = 0; i < 1000; i++) {
+        oldGrid.updateArea(stamps[i].first, stamps[i].second * 0.7f, false);
+        grid.updateArea(stamps[i].first, stamps[i].second * 0.7f, false);
+    }
+    int mismatches = 0;
+    for (int x = -70; x < 590; x++)
+        for (int z = -70; z < 590; z++)
+            if (oldGrid.isBlocked(x, z) != grid.isBlocked(x, z)) mismatches++;
+    printf("updateArea x5000: old %.2f ms, new %.2f ms; cell mismatches after 1000 clears %d\n", oldMs, newMs, mismatches);
+
+    // Random lookups
+    std::vector<int> xs(1 << 20), zs(1 << 20);
+    for (size_t i = 0; i < xs.size(); i++) {
+        xs[i] = rand() % 512;
+        zs[i] = rand() % 512;
+    }
+    long oldCount = 0, newCount = 0;
+    t = Clock::now();
+    for (int r = 0; r < 10; r++)
+        for (size_t i = 0; i < xs.size(); i++) oldCount += oldGrid.isBlocked(xs[i], zs[i]);
+    oldMs = msSince(t);
+    t = Clock::now();
+    for (int r = 0; r < 10; r++)
+        for (size_t i = 0; i < xs.size(); i++) newCount += grid.isBlocked(xs[i], zs[i]);
+    newMs = msSince(t);
+    printf("isBlocked x10M random: old %.1f ms, new %.1f ms (%ld/%ld blocked)\n", oldMs, newMs, oldCount, newCount);
+
+    // Building placement: the old check sampled every second cell of a radius-12 circle
+    int oldValid = 0, newValid = 0, exactMismatches = 0;
+    const float radius = 12.0f;
+    t = Clock::now();
+    for (int i = 0; i < 20000; i++) {
+        glm::vec3 p((float)xs[i], 0, (float)zs[i]);
+        bool valid = true;
+        int range = (int)radius;
+        for (int x = -range; x <= range && valid; x += 2) {
+            for (int z = -range; z <= range; z += 2) {
+                if (glm::length(glm::vec2(x, z)) > radius) continue;
+                int gx = (int)p.x + x, gz = (int)p.z + z;
+                if (gx < 0 || gx >= 512 || gz < 0 || gz >= 512 || oldGrid.isBlocked(gx, gz)) { valid = false; break; }
+            }
+        }
+        oldValid += valid;
+    }
+    oldMs = msSince(t);
+    grid.isCircleFree(glm::vec3(256, 0, 256), radius);  // builds the lazy clearance map outside the timing
+    t = Clock::now();
+    for (int i = 0; i < 20000; i++) newValid += grid.isCircleFree(glm::vec3((float)xs[i], 0, (float)zs[i]), radius);
+    newMs = msSince(t);
+    // Exact per-cell answer, to show the sampled check's misses are gone
+    for (int i = 0; i < 20000; i++) {
+        int cx = xs[i], cz = zs[i];
+        bool valid = true;
+        for (int x = -12; x <= 12 && valid; x++) {
+            for (int z = -12; z <= 12; z++) {
+                if (glm::length(glm::vec2(x, z)) > radius) continue;
+                if (oldGrid.isBlocked(cx + x, cz + z)) { valid = false; break; }
+            }
+        }
+        if (valid != grid.isCircleFree(glm::vec3((float)cx, 0, (float)cz), radius)) exactMismatches++;
+    }
+    printf("placement check x20000: old sampled %.2f ms (%d valid), isCircleFree %.2f ms (%d valid), mismatches vs exact per-cell %d\n",
+        oldMs, oldValid, newMs, newValid, exactMismatches);
+
+    // findNearestWalkable's 11x11 clearance square
+    int oldFree = 0, newFree = 0;
+    t = Clock::now();
+    for (int i = 0; i < 200000; i++) {
+        bool free = true;
+        for (int dx = -5; dx <= 5 && free; dx++)
+            for (int dz = -5; dz <= 5; dz++)
+                if (oldGrid.isBlocked(xs[i] + dx, zs[i] + dz)) { free = false; break; }
+        oldFree += free;
+    }
+    oldMs = msSince(t);
+    t = Clock::now();
+    for (int i = 0; i < 200000; i++) newFree += grid.isRectFree(xs[i] - 5, zs[i] - 5, xs[i] + 5, zs[i] + 5);
+    newMs = msSince(t);
+    printf("11x11 clearance x200k: old %.2f ms, isRectFree %.2f ms (%d/%d free)\n", oldMs, newMs, oldFree, newFree);
+    return 0;
+}
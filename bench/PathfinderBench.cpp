@@ -0,0 +1,56 @@
+// A* before and after the pooled search arena: the baseline Pathfinder (a new
+// Node per pushed neighbour, std::priority_queue, vector<bool> closed set) against
+// the current one in ASTAR mode, on the same baked map and the same queries.
+// Only queries the baseline solves are timed, so both sides do the same work.
+#include <vector>
+#include <queue>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <glm/glm.hpp>
+namespace baseline {
+#include "baseline/Pathfinder.h"
+}
+#include "../Pathfinder.h"
+#include "BenchMap.h"
+
+// Length of the walked route; the baseline returns every cell, the current
+// Pathfinder only the corners, so cell counts are not comparable
+static double pathLength(glm::vec3 start, const std::vector<glm::vec3>& path) {
+    double length = 0;
+    glm::vec3 from((int)start.x, 0, (int)start.z);
+    for (const glm::vec3& p : path) {
+        length += glm::distance(from, p);
+        from = p;
+    }
+    return length;
+}
+
+int main() {
+    baseline::NavigationGrid oldGrid(512, 512);
+    NavigationGrid grid(512, 512);
+    bakeMap(oldGrid);
+    bakeMap(grid);
+    Pathfinder::setMode(PathMode::ASTAR);
+
+    std::vector<std::pair<glm::vec3, glm::vec3>> all = makeQueries(grid, 800), queries;
+    for (auto& q : all)
+        if (!baseline::Pathfinder::findPath(q.first, q.second, &oldGrid).empty()) queries.push_back(q);
+    printf("%zu of %zu queries solved by the baseline A*\n", queries.size(), all.size());
+
+    typedef std::chrono::steady_clock Clock;
+    for (int run = 0; run < 3; run++) {
+        double oldLength = 0, newLength = 0;
+        Clock::time_point t0 = Clock::now();
+        for (auto& q : queries) oldLength += pathLength(q.first, baseline::Pathfinder::findPath(q.first, q.second, &oldGrid));
+        Clock::time_point t1 = Clock::now();
+        for (auto& q : queries) newLength += pathLength(q.first, Pathfinder::findPath(q.first, q.second, &grid));
+        Clock::time_point t2 = Clock::now();
+        printf("baseline %.1f ms, pooled %.1f ms (total length %.0f vs %.0f)\n",
+            std::chrono::duration<double, std::milli>(t1 - t0).count(),
+            std::chrono::duration<double, std::milli>(t2 - t1).count(), oldLength, newLength);
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Checks the batched movement pass (SteeringIntegrator) two ways:
+// - integrate() against integrateScalar(), over a slot range that starts off a
+//   multiple of 4 and ends with a scalar tail, to catch a wrong load4/store4
+//   shuffle or lane mix-up; slots outside the range must stay untouched.
+// - integrate() + clampToMap() against the per-unit physics Unit::update ran
+//   before the batch pass existed (open ground, so no wall sliding).
+// Prints each check and exits non-zero if one fails.
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "../SteeringIntegrator.h"
+
+static const float DT = 1.0f / 30.0f;
+
+// Largest difference relative to the magnitude (at least 1)
+static float relativeError(const glm::vec3& a, const glm::vec3& b) {
+    float worst = 0.0f;
+    for (int k = 0; k < 3; k++) worst = std::max(worst, std::fabs(a[k] - b[k]) / std::max(1.0f, std::fabs(b[k])));
+    return worst;
+}
+
+// Random units: a third idle, some over the speed limit, some about to stop
+static UnitStore randomUnits(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> coord(0.0f, 512.0f), force(-60.0f, 60.0f), speed(-14.0f, 14.0f);
+    UnitStore units;
+    for (size_t i = 0; i < count; i++) {
+        units.add(nullptr, UnitType::MELEE, glm::vec3(coord(rng), coord(rng) * 0.1f, coord(rng)), 0, 100);
+        units.state[i] = (i % 3 == 0) ? UnitState::IDLE : UnitState::MOVING;
+        units.steering[i] = glm::vec3(force(rng), 0.0f, force(rng));
+        units.velocity[i] = (i % 5 == 0) ? glm::vec3(0.05f, 0.0f, -0.05f) : glm::vec3(speed(rng), 0.0f, speed(rng));
+    }
+    return units;
+}
+
+static bool checkAgainstScalar() {
+    const size_t count = 20003, begin = 2, end = 20001;
+    UnitStore simd = randomUnits(count, 12345);
+    UnitStore scalar = simd;
+
+    std::vector<glm::vec3> nextSimd(end - begin), nextScalar(end - begin);
+    SteeringIntegrator::integrate(simd, DT, begin, end, nextSimd.data());
+    SteeringIntegrator::integrateScalar(scalar, DT, begin, end, nextScalar.data());
+    float worstVelocity = 0.0f, worstNext = 0.0f;
+    for (size_t i = begin; i < end; i++) {
+        worstVelocity = std::max(worstVelocity, relativeError(simd.velocity[i], scalar.velocity[i]));
+        worstNext = std::max(worstNext, relativeError(nextSimd[i - begin], nextScalar[i - begin]));
+    }
+    bool untouched = simd.velocity[0] == scalar.velocity[0] && simd.velocity[1] == scalar.velocity[1] &&
+                     simd.velocity[end] == scalar.velocity[end] && simd.velocity[end + 1] == scalar.velocity[end + 1];
+
+    // Out past the borders on purpose, then back in
+    for (size_t i = begin; i < end; i++) simd.position[i] = nextSimd[i - begin] * 1.2f - glm::vec3(40.0f, 0.0f, 40.0f);
+    scalar.position = simd.position;
+    SteeringIntegrator::clampToMap(simd, begin, end);
+    SteeringIntegrator::clampToMap(scalar, end, end); // Empty range: must not move anything
+    int clampMismatches = 0;
+    const float minCoord = SteeringIntegrator::BORDER_SIZE, maxCoord = SteeringIntegrator::MAP_SIZE - SteeringIntegrator::BORDER_SIZE;
+    for (size_t i = begin; i < end; i++) {
+        glm::vec3 p = scalar.position[i];
+        p.x = std::min(std::max(p.x, minCoord), maxCoord);
+        p.z = std::min(std::max(p.z, minCoord), maxCoord);
+        if (simd.position[i] != p) clampMismatches++;
+    }
+
+    bool ok = worstVelocity <= 1e-6f && worstNext <= 1e-6f && untouched && clampMismatches == 0;
+    printf("%s  SSE vs scalar, slots [%zu, %zu): max rel. error velocity %g, next position %g, outside range %s, clamp mismatches %d\n",
+        ok ? "PASS" : "FAIL", begin, end, worstVelocity, worstNext, untouched ? "untouched" : "CHANGED", clampMismatches);
+    return ok;
+}
+
+// The movement tail of Unit::update before the batch pass, minus the grid and
+// terrain lookups (wall sliding and height stay per unit in integrateMovement)
+static void perUnitReference(glm::vec3& position, glm::vec3& velocity, const glm::vec3& acc, bool isMovingState, float dt) {
+    velocity += acc * dt;
+    float maxSpeed = 10.0f;
+    if (glm::length(velocity) > maxSpeed) velocity = glm::normalize(velocity) * maxSpeed;
+
+    if (!isMovingState) velocity *= 0.5f;
+    else velocity *= 0.95f;
+
+    if (glm::length(velocity) < 0.1f) velocity = glm::vec3(0.0f);
+
+    position += velocity * dt;
+
+    if (position.x <= 0) position.x = 0.1f;
+    if (position.x >= 512) position.x = 511.9f;
+    if (position.z <= 0) position.z = 0.1f;
+    if (position.z >= 512) position.z = 511.9f;
+
+    float mapSize = 512.0f;
+    float borderSize = 30.0f;
+    if (position.x < borderSize) position.x = borderSize;
+    if (position.x > mapSize - borderSize) position.x = mapSize - borderSize;
+    if (position.z < borderSize) position.z = borderSize;
+    if (position.z > mapSize - borderSize) position.z = mapSize - borderSize;
+}
+
+static bool checkAgainstPerUnit() {
+    const size_t count = 20003;
+    UnitStore batch = randomUnits(count, 777);
+    UnitStore reference = batch;
+
+    std::vector<glm::vec3> next(count);
+    SteeringIntegrator::integrate(batch, DT, 0, count, next.data());
+    batch.position = next;
+    SteeringIntegrator::clampToMap(batch, 0, count);
+
+    float worstPosition = 0.0f, worstVelocity = 0.0f;
+    int stopMismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        perUnitReference(reference.position[i], reference.velocity[i], reference.steering[i], reference.state[i] == UnitState::MOVING, DT);
+        worstPosition = std::max(worstPosition, relativeError(batch.position[i], reference.position[i]));
+        worstVelocity = std::max(worstVelocity, relativeError(batch.velocity[i], reference.velocity[i]));
+        if ((batch.velocity[i] == glm::vec3(0.0f)) != (reference.velocity[i] == glm::vec3(0.0f))) stopMismatches++;
+    }
+
+    bool ok = worstPosition <= 1e-6f && worstVelocity <= 1e-6f && stopMismatches == 0;
+    printf("%s  batch vs old per-unit integration, %zu units: max rel. error position %g, velocity %g, stop mismatches %d\n",
+        ok ? "PASS" : "FAIL", count, worstPosition, worstVelocity, stopMismatches);
+    return ok;
+}
+
+int main() {
+#ifdef USE_SIMD_STEERING
+    printf("SSE2 path enabled\n");
+#else
+    printf("SSE2 not available: integrate() is the scalar path, the first check compares it with itself\n");
+#endif
+    bool ok = checkAgainstScalar();
+    ok = checkAgainstPerUnit() && ok;
+    return ok ? 0 : 1;
+}
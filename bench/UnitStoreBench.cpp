@@ -0,0 +1,115 @@
+// The per-frame sweeps over every unit (integrate, render batch classification,
+// snow-trail stamping, dead scan) over 10k units, once through heap objects laid
+// out like Unit before the UnitStore (hot fields scattered among queues, paths and
+// planners, allocated among other heap traffic, then shuffled by spawn and death
+// churn) and once over a UnitStore's arrays.
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <algorithm>
+#include "../UnitStore.h"
+
+// Same members, sizes and order as the Unit object the store replaced
+struct ObjectUnit {
+    int id;
+    int targetHandle[2];
+    std::deque<int> attackQueue;
+    int buildingHandle[2];
+    UnitType type;
+    int team;
+    glm::vec3 position;
+    glm::vec3 velocity;
+    void* mesh;
+    bool selected;
+    char path[24];
+    bool hasTarget;
+    char flow[16];
+    glm::vec3 slot;
+    char group[20];
+    int ticket, purpose;
+    glm::vec3 requestStart, requestTarget;
+    uint64_t version;
+    char planner[16];
+    glm::vec3 goal;
+    uint64_t plannerVersion;
+    UnitState state;
+    float stamina;
+    std::deque<int> taskQueue;
+    int currentTask;
+    float gatherTimer;
+    int maxHealth, health, damage;
+    float range, cooldown, timer;
+};
+
+static int animationOf(UnitState state, const glm::vec3& velocity) {
+    if (state == UnitState::ATTACKING || state == UnitState::ATTACKING_BUILDING || state == UnitState::GATHERING) return 2;
+    return glm::length(velocity) > 0.1f ? 1 : 0;
+}
+
+int main() {
+    const int UNITS = 10000, FRAMES = 200;
+    const float dt = 1.0f / 60.0f;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> coord(40.0f, 470.0f);
+
+    std::vector<std::unique_ptr<ObjectUnit>> objects;
+    std::vector<std::unique_ptr<std::string>> otherAllocations;
+    for (int i = 0; i < UNITS; i++) {
+        objects.emplace_back(new ObjectUnit());
+        ObjectUnit& u = *objects.back();
+        u.position = glm::vec3(coord(rng), 0, coord(rng));
+        u.velocity = glm::vec3(coord(rng) * 0.01f, 0, 0);
+        u.type = UnitType(i % 3);
+        u.team = i & 1;
+        u.state = UnitState(i % 5);
+        u.health = 100;
+        for (int k = 0; k < 3; k++) otherAllocations.emplace_back(new std::string(40 + rng() % 200, 'x'));
+    }
+    std::shuffle(objects.begin(), objects.end(), rng);
+
+    UnitStore store;
+    for (auto& u : objects) {
+        int slot = store.add(nullptr, u->type, u->position, u->team, u->health);
+        store.velocity[slot] = u->velocity;
+        store.state[slot] = u->state;
+    }
+    printf("sizeof(ObjectUnit) = %zu\n", sizeof(ObjectUnit));
+
+    typedef std::chrono::steady_clock Clock;
+    double sink = 0;
+    Clock::time_point t = Clock::now();
+    for (int f = 0; f < FRAMES; f++) {
+        for (auto& u : objects) u->position += u->velocity * dt;
+        int batches[3][3] = {};
+        for (auto& u : objects)
+            if (u->position.x > 0) batches[(int)u->type][animationOf(u->state, u->velocity)]++;
+        glm::vec3 trail(0.0f);
+        for (auto& u : objects) trail += u->position;
+        int dead = 0;
+        for (auto& u : objects) dead += u->health <= 0;
+        sink += batches[1][1] + trail.x + dead;
+    }
+    double objectMs = std::chrono::duration<double, std::milli>(Clock::now() - t).count() / FRAMES;
+
+    t = Clock::now();
+    for (int f = 0; f < FRAMES; f++) {
+        size_t n = store.size();
+        for (size_t i = 0; i < n; i++) store.position[i] += store.velocity[i] * dt;
+        int batches[3][3] = {};
+        for (size_t i = 0; i < n; i++)
+            if (store.position[i].x > 0) batches[(int)store.type[i]][animationOf(store.state[i], store.velocity[i])]++;
+        glm::vec3 trail(0.0f);
+        for (size_t i = 0; i < n; i++) trail += store.position[i];
+        int dead = 0;
+        for (size_t i = 0; i < n; i++) dead += store.health[i] <= 0;
+        sink += batches[1][1] + trail.x + dead;
+    }
+    double storeMs = std::chrono::duration<double, std::milli>(Clock::now() - t).count() / FRAMES;
+
+    printf("%d units, per-frame sweeps: objects %.3f ms, UnitStore %.3f ms (%.1fx)  [%g]\n",
+        UNITS, objectMs, storeMs, objectMs / storeMs, sink);
+    return 0;
+}
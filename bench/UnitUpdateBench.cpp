@@ -0,0 +1,113 @@
+// Unit::update throughput with 10k units on the baked map: two armies in their
+// own halves (too far apart to fight), a quarter of each re-ordered across its
+// half every two seconds, the rest idle. Every unit updates every tick on one
+// thread, so the figure is per-unit update cost, not scheduling or threading.
+// Times the unit update phase only; path searches (inline, zero workers, no
+// budget) and the spatial hash rebuilds are reported separately.
+//
+// Built against the current tree by default. The user-018 commit message
+// compares the tree before and after that commit, whose Unit::update had an
+// older signature; build with -DUNIT_UPDATE_018=0 on the parent of that commit
+// and -DUNIT_UPDATE_018=1 on the commit itself.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "../Unit.h"
+#include "../SpatialHash.h"
+#include "../NavigationGrid.h"
+#include "../PathRequestService.h"
+#include "../PathCache.h"
+#ifndef UNIT_UPDATE_018
+#include "../UnitEvents.h"
+#endif
+#include "BenchMap.h"
+
+typedef std::chrono::steady_clock Clock;
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// A random open cell in the team's half
+static glm::vec3 randomCell(const NavigationGrid& grid, int team, std::mt19937& rng) {
+    std::uniform_real_distribution<float> x(45.0f, 215.0f), z(45.0f, 465.0f);
+    while (true) {
+        glm::vec3 p(x(rng), 0.0f, z(rng));
+        if (team == 1) p.x += 252.0f;
+        if (!grid.isBlocked((int)p.x, (int)p.z)) return p;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int UNITS = argc > 1 ? atoi(argv[1]) : 10000;
+    const int TICKS = 600, REORDER_TICKS = 120;
+    const float dt = 1.0f / 60.0f;
+
+    // Stand-in meshes, so the Unit ctor does not load models; nothing here draws
+    static char meshStandIn;
+    Unit::minionMesh = Unit::warriorMesh = Unit::mageMesh = reinterpret_cast<SkinnedMesh*>(&meshStandIn);
+
+    NavigationGrid grid(512, 512);
+    bakeMap(grid);
+    // No search budget: every ordered unit gets its path the next tick and really moves
+    PathRequestService paths(&grid, 0, 1 << 30);
+    PathRequestService::setActive(&paths);
+    PathCache cache(&grid);
+    PathCache::setActive(&cache);
+    SpatialHash unitGrid(512.0f);
+    Resources resources;
+
+    std::mt19937 rng(7);
+    std::vector<std::unique_ptr<Unit>> units;
+    for (int i = 0; i < UNITS; i++) {
+        int team = i & 1;
+        units.emplace_back(new Unit(UnitType((i / 2) % 3), randomCell(grid, team, rng), team));
+    }
+
+#ifndef UNIT_UPDATE_018
+    TeamSpatialIndex hostileGrid(512.0f);
+    UnitEvents events;
+    CombatLog combat;
+#endif
+
+    double updateMs = 0, pathMs = 0, rebuildMs = 0;
+    for (int tick = 0; tick < TICKS; tick++) {
+        if (tick % REORDER_TICKS == 0) {
+            for (size_t i = (tick / REORDER_TICKS) % 4; i < units.size(); i += 4)
+                units[i]->moveTo(randomCell(grid, (int)(i & 1), rng), &grid);
+        }
+
+        Clock::time_point t = Clock::now();
+#if defined(UNIT_UPDATE_018) && UNIT_UPDATE_018 == 0
+        unitGrid.rebuild(units);
+#else
+        unitGrid.rebuild(Unit::store());
+#endif
+#ifndef UNIT_UPDATE_018
+        hostileGrid.rebuild(Unit::store());
+#endif
+        rebuildMs += msSince(t);
+
+        t = Clock::now();
+        paths.applyResults(UNITS);
+        pathMs += msSince(t);
+
+        t = Clock::now();
+#ifdef UNIT_UPDATE_018
+        for (auto& u : units) u->update(dt, nullptr, unitGrid, resources, nullptr, &grid);
+#else
+        // simulationStep on one thread: updates, the batched movement, then side effects
+        Unit::beginTick();
+        for (auto& u : units) u->update(dt, unitGrid, hostileGrid, nullptr, &grid, events);
+        Unit::integrateMovement(dt, 0, Unit::store().size(), nullptr, &grid);
+        combat.begin();
+        events.apply(resources, nullptr, &grid, combat);
+        Unit::resolveCombat(combat);
+        for (auto& u : units) u->submitPathRequest(&grid);
+#endif
+        updateMs += msSince(t);
+    }
+
+    printf("%d units, %d ticks: unit update %.2f ms/tick (%.0f ns per unit), path results %.2f ms/tick, hash rebuild %.2f ms/tick\n",
+        UNITS, TICKS, updateMs / TICKS, updateMs / TICKS * 1e6 / UNITS, pathMs / TICKS, rebuildMs / TICKS);
+    return 0;
+}
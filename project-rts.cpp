@@ -23,8 +23,19 @@
 #include "Resource.h"
 #include "SkinnedMesh.h"
 #include "Pathfinder.h"
+#include "FlowField.h"
+#include "PathRequestService.h"
+#include "PathCache.h"
+#include "CooperativePathfinder.h"
+#include "SpatialHash.h"
+#include "UnitEvents.h"
+#include "WorkerPool.h"
+#include "UpdateScheduler.h"
 #include "NavigationGrid.h"
 #include "Frustum.h"
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
 
 #include "ParticleManager.h"
 
@@ -36,6 +47,15 @@ using namespace glm;
 #define W_HEIGHT 1080 //1080
 #define TITLE "RTS Project"
 // ---------------------------------------------------------------
+// Every heap allocation in the game goes through here, to be counted (K prints them)
+void* operator new(size_t size) {
+    AllocationCounter::record();
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+// ---------------------------------------------------------------
 GLFWwindow* window = nullptr;
 Camera* camera = nullptr;
 GLuint shaderProgram = 0;
@@ -83,6 +103,28 @@ GLuint fireTexture = 0;
 GLuint whiteShader = 0;
 
 NavigationGrid* navGrid = nullptr;
+HierarchicalPathfinder* pathHierarchy = nullptr;
+LandmarkHeuristic* pathLandmarks = nullptr;
+std::vector<std::weak_ptr<CooperativeGroup>> moveGroups; // Alive while any member still follows it
+bool cooperativeMoves = true; // Group moves reserve space-time cells (M toggles)
+uint64_t allocationsLastFrame = 0; // Heap allocations made during the previous frame
+uint64_t allocationsWorstFrame = 0; // ... and the most in one frame since the last report (K)
+uint64_t allocationFrames = 0;
+PathRequestService* pathService = nullptr;
+PathCache* pathCache = nullptr;
+const int PATH_RESULTS_PER_FRAME = 64; // Finished searches handed to units per frame
+const int PATH_EXPANSIONS_PER_FRAME = 8000; // A* work per frame when there are no path workers
+const int LANDMARK_CELLS_PER_FRAME = 5000; // Landmark table rebuild work per frame (a millisecond or two)
+WorkerPool* updatePool = nullptr;
+std::vector<UnitEvents> unitEvents; // Side effects of each update chunk, applied in chunk order
+CombatLog combatLog; // This tick's attacks, hits, impacts and deaths
+UpdateScheduler updateScheduler; // Which units run their FSM each tick (U toggles and reports)
+std::vector<UpdateScheduler::Due> dueUnits;
+const int UNIT_UPDATE_CHUNK = 128; // Units per update task
+const float SIM_STEPS_PER_SECOND = 30.0f; // Fixed simulation rate, independent of the frame rate
+const float SIM_STEP = 1.0f / SIM_STEPS_PER_SECOND;
+const int MAX_SIM_STEPS_PER_FRAME = 4; // Catch-up limit: after a longer hitch the game slows down instead of stalling
+float simAlpha = 1.0f; // Where this frame falls between the last two sim steps (0 = previous, 1 = latest)
 
 
 // Uniform locations (standard shader)
@@ -104,7 +146,7 @@ glm::vec3 dragEndWorld;
 
 // Camera Mode State
 bool unitCameraMode = false;
-Unit* focusedUnit = nullptr;
+UnitHandle focusedUnit; // Resolves to nullptr once the unit is gone
 
 // ---------------------------------------------------------------
 struct Light {
@@ -136,6 +178,8 @@ bool isPlacementValid = false;
 BuildingType currentPlaceType = BuildingType::TOWN_CENTER;
 std::unique_ptr<Building> previewBuilding = nullptr;
 std::vector<std::unique_ptr<Unit>> units;
+SpatialHash unitGrid(512.0f); // Unit positions, rebuilt each frame right after dead units are removed
+TeamSpatialIndex hostileGrid(512.0f); // Same, one grid per team, for units looking for enemies
 
 Resources playerResources;
 // ---------------------------------------------------------------
@@ -367,6 +411,29 @@ void createContext()
         }
     }
 
+    // BUILD PATH HIERARCHY (after the bake, later changes rebuild only the clusters they touch)
+    pathHierarchy = new HierarchicalPathfinder(navGrid, Pathfinder::BORDER_SIZE);
+    Pathfinder::setHierarchy(pathHierarchy);
+
+    // LANDMARK TABLES (sharper A* estimate; rebuilt a slice per frame once enough of the map changed)
+    pathLandmarks = new LandmarkHeuristic(navGrid, Pathfinder::BORDER_SIZE);
+    Pathfinder::setLandmarks(pathLandmarks);
+
+    // PATH WORKERS (Units get their paths a frame or two later instead of stalling the frame)
+    // A single core gets none: searches then run on the main thread, a budget per frame
+    int pathWorkers = (int)std::thread::hardware_concurrency() - 1;
+    pathWorkers = std::max(0, std::min(pathWorkers, 4));
+    pathService = new PathRequestService(navGrid, pathWorkers, PATH_EXPANSIONS_PER_FRAME);
+    PathRequestService::setActive(pathService);
+
+    // UNIT UPDATE THREADS (results are the same with any count, see UnitEvents.h)
+    int updateThreads = (int)std::thread::hardware_concurrency() - 1;
+    updatePool = new WorkerPool(std::max(0, std::min(updateThreads, 7)));
+
+    // PATH CACHE (Grid changes only evict the paths they touch)
+    pathCache = new PathCache(navGrid);
+    PathCache::setActive(pathCache);
+
     //Particles
     ParticleManager::init(new Drawable("models/sphere.obj"));
     particleShaderProgram = loadShaders("ParticleShader.vertexshader", "ParticleShader.fragmentshader");
@@ -443,6 +510,76 @@ void handleInput() {
     }
     lastB = glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS;
 
+    static bool lastP = false;
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS && !lastP) {
+        // Cycle A* -> JPS -> HPA* -> A*. The HPA* cluster graph only describes the live
+        // grid, and path workers search a copy of it (where HPA* falls back to A*), so
+        // with workers running the cycle is just A* -> JPS -> A*
+        bool workers = pathService && pathService->getWorkerCount() > 0;
+        PathMode mode = Pathfinder::getMode();
+        if (mode == PathMode::ASTAR) Pathfinder::setMode(PathMode::JPS);
+        else if (mode == PathMode::JPS && !workers) Pathfinder::setMode(PathMode::HIERARCHICAL);
+        else Pathfinder::setMode(PathMode::ASTAR);
+        std::cout << ">>> PATHFINDER: " << Pathfinder::getModeName(Pathfinder::getMode()) << " <<<" << std::endl;
+        if (workers && mode == PathMode::JPS) {
+            std::cout << "HPA* skipped: " << pathService->getWorkerCount() << " path workers search a grid copy with A*" << std::endl;
+        }
+    }
+    lastP = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+
+    static bool lastM = false;
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS && !lastM) {
+        cooperativeMoves = !cooperativeMoves;
+        std::cout << ">>> GROUP MOVES: " << (cooperativeMoves ? "COOPERATIVE" : "FLOW FIELD ONLY") << " <<<" << std::endl;
+    }
+    lastM = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
+
+    static bool lastU = false;
+    if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS && !lastU) {
+        // Report what the update scheduler saved since the last toggle, then switch it
+        const UpdateScheduler::Stats& stats = updateScheduler.getStats();
+        std::cout << "Units active/visible/hidden: " << stats.units[UpdateScheduler::ACTIVE] << "/"
+            << stats.units[UpdateScheduler::VISIBLE] << "/" << stats.units[UpdateScheduler::HIDDEN]
+            << ", updates run: " << updateScheduler.getTotalUpdated() << ", skipped: " << updateScheduler.getTotalSkipped()
+            << ", saved ~" << updateScheduler.getSavedMs() << " ms" << std::endl;
+        updateScheduler.resetTotals();
+        updateScheduler.setEnabled(!updateScheduler.isEnabled());
+        std::cout << ">>> UPDATE LOD: " << (updateScheduler.isEnabled() ? "ON" : "OFF") << " <<<" << std::endl;
+    }
+    lastU = glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS;
+
+    static bool lastL = false;
+    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS && !lastL) {
+        // Report the average A* work since the last toggle, then switch the landmark estimate
+        uint64_t searches = Pathfinder::getTotalSearches();
+        if (searches > 0) {
+            std::cout << "Searches: " << searches << ", avg expanded: " << Pathfinder::getTotalExpanded() / searches << std::endl;
+        }
+        if (pathLandmarks) {
+            std::cout << "Landmark tables built: " << pathLandmarks->getBuildCount()
+                << ", dropped after a wall was cleared: " << pathLandmarks->getDiscardCount() << std::endl;
+        }
+        Pathfinder::resetTotals();
+        Pathfinder::setLandmarks(Pathfinder::getLandmarks() ? nullptr : pathLandmarks);
+        std::cout << ">>> LANDMARKS: " << (Pathfinder::getLandmarks() ? "ON" : "OFF") << " <<<" << std::endl;
+    }
+    lastL = glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS;
+
+    static bool lastK = false;
+    static uint64_t reportedAllocations = AllocationCounter::get();
+    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS && !lastK) {
+        // Report heap allocations since the last report and how full the unit pool is
+        uint64_t total = AllocationCounter::get();
+        const ObjectPool<Unit>& pool = Unit::pool();
+        std::cout << "Allocations: " << total - reportedAllocations << " in " << allocationFrames << " frames"
+            << " (last frame: " << allocationsLastFrame << ", worst: " << allocationsWorstFrame << ")"
+            << ", unit pool: " << pool.getLive() << "/" << pool.getCapacity() << " in " << pool.getChunkCount() << " chunks" << std::endl;
+        reportedAllocations = total;
+        allocationsWorstFrame = 0;
+        allocationFrames = 0;
+    }
+    lastK = glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS;
+
     // -------------------------------------------------------
     // 2. LEFT MOUSE: SELECTION & ACTION
     // -------------------------------------------------------
@@ -475,23 +612,19 @@ void handleInput() {
         if (currentMode == InputMode::UNIT_SELECT) {
             if (!shiftHeld) {
                 for (auto& u : units) u->setSelected(false);
-                focusedUnit = nullptr;
+                focusedUnit = UnitHandle();
                 unitCameraMode = false;
             }
             if (isClick) {
-                float minDist = 5.0f;
-                Unit* closest = nullptr;
-                for (auto& u : units) {
-                    float dist = distance(u->getPosition(), dragEndWorld);
-                    if (dist < minDist) { minDist = dist; closest = u.get(); }
-                }
+                Unit* closest = unitGrid.nearest(dragEndWorld, 5.0f);
                 if (closest) closest->setSelected(true);
             }
             else {
-                for (auto& u : units) {
-                    vec2 sPos = worldToScreen(u->getPosition(), V, P);
+                const UnitStore& hot = Unit::store();
+                for (size_t i = 0; i < hot.size(); i++) {
+                    vec2 sPos = worldToScreen(hot.renderPosition(i, simAlpha), V, P);
                     if (sPos.x >= minX && sPos.x <= maxX && sPos.y >= minY && sPos.y <= maxY) {
-                        u->setSelected(true);
+                        hot.owner[i]->setSelected(true);
                     }
                 }
             }
@@ -560,33 +693,24 @@ void handleInput() {
                 // 1. Check for Enemy UNITS
                 // ---------------------------------------------
                 std::vector<Unit*> enemyTargets;
-                for (auto& u : units) {
-                    if (u->getTeam() == 1) { // Is Enemy
-                        bool targeted = false;
-                        if (isClick) {
-                            if (distance(u->getPosition(), clickPos) < 10.0f) targeted = true;
-                        }
-                        else {
+                if (isClick) {
+                    unitGrid.queryRadius(clickPos, 10.0f, enemyTargets, 1); // Enemies near the click
+                }
+                else {
+                    for (auto& u : units) {
+                        if (u->getTeam() == 1) { // Is Enemy
                             vec2 sPos = worldToScreen(u->getPosition(), V, P);
-                            if (sPos.x >= minX && sPos.x <= maxX && sPos.y >= minY && sPos.y <= maxY) targeted = true;
+                            if (sPos.x >= minX && sPos.x <= maxX && sPos.y >= minY && sPos.y <= maxY) enemyTargets.push_back(u.get());
                         }
-                        if (targeted) enemyTargets.push_back(u.get());
                     }
                 }
 
                 if (!enemyTargets.empty()) {
                     //std::cout << "Command: ATTACK UNITS (" << enemyTargets.size() << " enemies queued)" << std::endl;
                     commandIssued = true;
-                    // SMART QUEUEING (Units)
+                    // SMART QUEUEING (Units): each unit takes the closest one left as it goes
                     for (auto* myUnit : myUnits) {
-                        std::vector<Unit*> sortedTargets = enemyTargets;
-                        std::sort(sortedTargets.begin(), sortedTargets.end(),
-                            [myUnit](Unit* a, Unit* b) {
-                                float distA = glm::distance(myUnit->getPosition(), a->getPosition());
-                                float distB = glm::distance(myUnit->getPosition(), b->getPosition());
-                                return distA < distB;
-                            });
-                        myUnit->assignAttackQueue(sortedTargets);
+                        myUnit->assignAttackQueue(enemyTargets);
                     }
                 }
 
@@ -603,9 +727,16 @@ void handleInput() {
                                 std::cout << "Command: ATTACK BUILDING!" << std::endl;
                                 commandIssued = true;
 
-                                // Order all selected units to attack this building
-                                for (auto* myUnit : myUnits) {
-                                    myUnit->assignAttackTask(b.get());
+                                // Order all selected units to attack this building.
+                                // One search from the building serves the whole group; the area is
+                                // inside every unit's reach (building radius 14 + 5 + attack range).
+                                std::vector<vec3> starts;
+                                for (auto* myUnit : myUnits) starts.push_back(myUnit->getPosition());
+                                std::vector<std::vector<vec3>> paths = Pathfinder::findPathsToArea(starts, b->getPosition(), 19.0f, navGrid);
+
+                                for (size_t i = 0; i < myUnits.size(); i++) {
+                                    myUnits[i]->assignAttackTask(b.get());
+                                    if (!paths[i].empty()) myUnits[i]->setPath(paths[i]);
                                 }
                                 break; // Target found
                             }
@@ -646,40 +777,42 @@ void handleInput() {
         for (auto& u : units) if (u->isSelected() && u->getTeam() == 0) myUnits.push_back(u.get());
 
         if (!myUnits.empty()) {
-            std::cout << "Command: Move (Shared Path + Formation)" << std::endl;
-
-            // 1. Calculate Group Center
-            vec3 groupCenter(0.0f);
-            for (auto* u : myUnits) groupCenter += u->getPosition();
-            groupCenter /= (float)myUnits.size();
-
-            // 2. Calculate ONE path from Center -> Mouse Click
-            std::vector<vec3> sharedPath = Pathfinder::findPath(groupCenter, clickPos, navGrid);
-
-            // 3. Assign path, but give each unit a unique END POINT
             int count = myUnits.size();
             float spacing = 3.0f;
 
-            for (int i = 0; i < count; i++) {
-                // Calculate Formation Offset (Spiral)
-                float radius = spacing * std::sqrt(i);
-                float angle = i * 2.4f;
-                vec3 offset(cos(angle) * radius, 0.0f, sin(angle) * radius);
+            if (count == 1) {
+                std::cout << "Command: Move" << std::endl;
+                myUnits[0]->moveTo(clickPos, navGrid);
+            }
+            else {
+                std::cout << "Command: Move (Flow Field + Formation)" << std::endl;
+
+                // 1. Build ONE field towards the whole formation area
+                std::vector<vec3> starts;
+                for (auto* u : myUnits) starts.push_back(u->getPosition());
+
+                float formationRadius = spacing * std::sqrt((float)count) + 1.0f;
+                auto field = std::make_shared<FlowField>(navGrid);
+                bool built = field->build(clickPos, formationRadius, starts);
+                vec3 goal = built ? field->getGoal() : clickPos;
+                std::shared_ptr<const FlowField> sharedField = field;
+                std::shared_ptr<CooperativeGroup> group;
+                if (built && cooperativeMoves) {
+                    group = std::make_shared<CooperativeGroup>(navGrid, sharedField);
+                    moveGroups.push_back(group);
+                }
 
-                // Copy the shared path
-                std::vector<vec3> myPersonalPath = sharedPath;
+                // 2. Every unit follows the field, then settles on its own spot
+                for (int i = 0; i < count; i++) {
+                    // Calculate Formation Offset (Spiral)
+                    float radius = spacing * std::sqrt(i);
+                    float angle = i * 2.4f;
+                    vec3 offset(cos(angle) * radius, 0.0f, sin(angle) * radius);
 
-                //Change the LAST point to be their unique spot
-                if (!myPersonalPath.empty()) {
-                    myPersonalPath.back() = clickPos + offset;
-                }
-                else {
-                    // If path was empty (very close), just push the single point
-                    myPersonalPath.push_back(clickPos + offset);
+                    myUnits[i]->clearTasks();
+                    if (built) myUnits[i]->setFlowField(sharedField, goal + offset);
+                    if (group) myUnits[i]->setMoveGroup(group, group->addMember(myUnits[i]->getPosition(), goal + offset));
                 }
-
-                myUnits[i]->clearTasks();
-                myUnits[i]->setPath(myPersonalPath);
             }
 
             // Visual cleanup
@@ -703,10 +836,10 @@ void handleInput() {
             unitCameraMode = false;
         }
         else {
-            focusedUnit = nullptr;
+            focusedUnit = UnitHandle();
             for (auto& u : units) {
                 if (u->isSelected()) {
-                    focusedUnit = u.get();
+                    focusedUnit = u->getHandle();
                     unitCameraMode = true;
                     break;
                 }
@@ -810,13 +943,15 @@ void drawSelectionRings(mat4 V, mat4 P) {
     // ---------------------------------------------------------
     // 1. Rings for SELECTED UNITS (Status Colors)
     // ---------------------------------------------------------
-    for (const auto& u : units) {
-        if (u->isSelected()) {
-            vec3 pos = u->getPosition();
+    const UnitStore& hot = Unit::store();
+    for (size_t u = 0; u < hot.size(); u++) {
+        if (hot.selected[u]) {
+            vec3 pos = hot.renderPosition(u, simAlpha);
 
             // Dynamic Color Logic
-            if (u->isGathering()) glColor3f(1.0f, 1.0f, 0.0f);      // Yellow (Working)
-            else if (u->isAttacking() || u->isAttackingBuilding()) glColor3f(1.0f, 0.0f, 0.0f); // Red (Fighting)
+            UnitState state = hot.state[u];
+            if (state == UnitState::GATHERING) glColor3f(1.0f, 1.0f, 0.0f);      // Yellow (Working)
+            else if (state == UnitState::ATTACKING || state == UnitState::ATTACKING_BUILDING) glColor3f(1.0f, 0.0f, 0.0f); // Red (Fighting)
             else glColor3f(0.0f, 1.0f, 0.0f);                       // Green (Idle)
 
             glLineWidth(2.0f);
@@ -838,9 +973,9 @@ void drawSelectionRings(mat4 V, mat4 P) {
     if (currentMode == InputMode::ATTACK_SELECT) {
 
         // A. Enemy Units
-        for (const auto& u : units) {
-            if (u->getTeam() == 1) { // Enemy
-                vec3 pos = u->getPosition();
+        for (size_t u = 0; u < hot.size(); u++) {
+            if (hot.team[u] == 1) { // Enemy
+                vec3 pos = hot.renderPosition(u, simAlpha);
                 glColor3f(1.0f, 0.0f, 0.0f); // Red Ring
                 glLineWidth(2.0f);
                 glBegin(GL_LINE_LOOP);
@@ -980,31 +1115,12 @@ void updateBuildingPlacement()
         else if (currentPlaceType == BuildingType::BARRACKS) buildingRadius = 12.0f;
         else if (currentPlaceType == BuildingType::SHOOTING_RANGE) buildingRadius = 10.0f;
 
-        // VALIDITY CHECK LOOP
-        // Assume valid until we hit a block
+        // VALIDITY CHECK
+        // Every cell the building would cover must be free (off the map counts as blocked)
         bool valid = true;
 
         if (navGrid) {
-            int range = (int)buildingRadius;
-
-            for (int x = -range; x <= range; x += 2) {
-                for (int z = -range; z <= range; z += 2) {
-
-                    // Circular check
-                    if (glm::length(glm::vec2(x, z)) > buildingRadius) continue;
-
-                    int gridX = (int)pos.x + x;
-                    int gridZ = (int)pos.z + z;
-
-                    // Check Bounds & Collisions
-                    if (gridX < 0 || gridX >= 512 || gridZ < 0 || gridZ >= 512 ||
-                        navGrid->isBlocked(gridX, gridZ)) {
-                        valid = false;
-                        break;
-                    }
-                }
-                if (!valid) break;
-            }
+            valid = navGrid->isCircleFree(pos, buildingRadius);
         }
 
         // Update the global variable for the renderer to see
@@ -1311,8 +1427,138 @@ void initialize()
 
 }
 
+// One fixed step of the game simulation: units, buildings, spawning and everything
+// they drive. Runs SIM_STEPS_PER_SECOND times a second however fast we render.
+void simulationStep(float dt) {
+    // 1. Remove Dead Units (Clean up the vector)
+    units.erase(std::remove_if(units.begin(), units.end(),
+        [](const std::unique_ptr<Unit>& u) {
+            return u->isDead();
+        }), units.end());
+    unitGrid.rebuild(Unit::store());
+    hostileGrid.rebuild(Unit::store());
+
+    // 2. Plan the next window of every group move still under way
+    for (size_t i = 0; i < moveGroups.size();) {
+        std::shared_ptr<CooperativeGroup> group = moveGroups[i].lock();
+        if (!group) { moveGroups.erase(moveGroups.begin() + i); continue; }
+        group->update(dt);
+        i++;
+    }
+
+    // 3. Update Remaining Units
+    // Only the units due this tick (busy ones every tick, quiet ones every few ticks).
+    // Chunks of them update in parallel, each seeing the others as they were at the
+    // start of the tick; their side effects then apply in unit order on this thread
+    Unit::beginTick();
+    updateScheduler.schedule(units, dt, unitGrid,
+        [](const glm::vec3& pos) { return cameraFrustum.isSphereVisible(pos, 3.0f); }, dueUnits);
+    double updateStart = glfwGetTime();
+    int chunks = ((int)dueUnits.size() + UNIT_UPDATE_CHUNK - 1) / UNIT_UPDATE_CHUNK;
+    if ((int)unitEvents.size() < chunks) unitEvents.resize(chunks);
+    updatePool->run(chunks, [&](int c) {
+        size_t end = std::min(dueUnits.size(), (size_t)(c + 1) * UNIT_UPDATE_CHUNK);
+        for (size_t i = (size_t)c * UNIT_UPDATE_CHUNK; i < end; i++) {
+            dueUnits[i].unit->update(dueUnits[i].dt, unitGrid, hostileGrid, environment, navGrid, unitEvents[c]);
+        }
+    });
+    updateScheduler.recordUpdateTime((glfwGetTime() - updateStart) * 1000.0);
+    // Then everyone moves by the forces they just worked out, in slot order over the store
+    size_t slots = Unit::store().size();
+    int moveChunks = (int)((slots + UNIT_UPDATE_CHUNK - 1) / UNIT_UPDATE_CHUNK);
+    updatePool->run(moveChunks, [&](int c) {
+        size_t begin = (size_t)c * UNIT_UPDATE_CHUNK;
+        Unit::integrateMovement(dt, begin, std::min(slots, begin + UNIT_UPDATE_CHUNK), terrain, navGrid);
+    });
+    combatLog.begin();
+    for (int c = 0; c < chunks; c++) unitEvents[c].apply(playerResources, environment, navGrid, combatLog);
+    Unit::resolveCombat(combatLog);
+    for (auto& u : units) u->submitPathRequest(navGrid);
+    
+
+    // -------------------------------------------------------
+    // UPDATE BUILDINGS & AUTO-SPAWN (With Spiral Formation)
+    // -------------------------------------------------------
+    for (auto& b : buildings) {
+        b->updateConstruction(dt);
+
+        UnitType typeToSpawn = b->updateAutoSpawning(dt);
+
+        if ((int)typeToSpawn != -1) {
+
+            // --- 1. Define Rally Point (In Front of Building) ---
+            glm::vec3 buildingPos = b->getPosition();
+
+            //  Calculate "Front" Vector based on Building Rotation (160 degrees)
+            // We convert 160 degrees to radians to get the direction the door is facing.
+            float rotationRadians = glm::radians(160.0f);
+
+            // Assuming the mesh's natural forward is +Z (common for assets)
+            // We rotate the vector (0,0,1) by 160 degrees.
+            float dirX = sin(rotationRadians);
+            float dirZ = cos(rotationRadians);
+
+            glm::vec3 forwardDir(dirX, 0.0f, dirZ);
+
+            // Move the center 30 units out along that direction
+            glm::vec3 rallyCenter = buildingPos + (forwardDir * 10.0f);
+
+            // --- 2. Calculate Spiral Offset ---
+            // Use the number of units spawned so far (1 to 10) as the index 'i'
+            int i = b->getSpawnedCount();
+            float spacing = 3.0f; // Space between units
+
+            // The Spiral Formula:
+            float radius = spacing * std::sqrt(i);
+            float angle = i * 2.4f; // Golden Angle for nice packing
+
+            // Offset relative to the Rally Center
+            glm::vec3 offset(cos(angle) * radius, 0.0f, sin(angle) * radius);
+
+            // Final Target Position
+            glm::vec3 spawnPos = rallyCenter + offset;
+
+            // --- 3. Validate Position ---
+            // Ensure we don't spawn inside a rock or tree
+            if (navGrid && navGrid->isBlocked((int)spawnPos.x, (int)spawnPos.z)) {
+                spawnPos = Pathfinder::findNearestWalkable((int)spawnPos.x, (int)spawnPos.z, navGrid);
+            }
+
+            // --- 4. Spawn Unit ---
+            if (spawnPos.x != -1.0f) {
+                auto newUnit = std::make_unique<Unit>(typeToSpawn, spawnPos, b->getTeam());
+
+                // Optional: Make them physically look away from the building initially
+                // newUnit->setRotation(160.0f); 
+
+                units.push_back(std::move(newUnit));
+            }
+        }
+    }
+
+    // -------------------------------------------------------
+    // REMOVE DEAD BUILDINGS
+    // -------------------------------------------------------
+    auto it = buildings.begin();
+    while (it != buildings.end()) {
+        if ((*it)->isDead()) {
+            // Unblock Grid
+            float r = ((*it)->getType() == BuildingType::TOWN_CENTER) ? 12.0f : 8.0f;
+            if (navGrid) {
+                navGrid->updateArea((*it)->getPosition(), r, false);
+            }
+            std::cout << "Building Destroyed!" << std::endl;
+            it = buildings.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
 void mainLoop() {
     float lastTime = static_cast<float>(glfwGetTime());
+    float simAccumulator = 0.0f;
     const float cycleSpeed = 0.002f;
 
     static bool showDepthMap = false;
@@ -1320,11 +1566,20 @@ void mainLoop() {
 
     static float unitCameraAngle = 0; // Start facing unit front
 
+    uint64_t frameAllocations = AllocationCounter::get();
+
     do {
         float currentTime = static_cast<float>(glfwGetTime());
         float dt = currentTime - lastTime;
         lastTime = currentTime;
 
+        // 0. ALLOCATIONS made by the previous frame
+        uint64_t allocations = AllocationCounter::get();
+        allocationsLastFrame = allocations - frameAllocations;
+        allocationsWorstFrame = std::max(allocationsWorstFrame, allocationsLastFrame);
+        allocationFrames++;
+        frameAllocations = allocations;
+
         // 1. UPDATE SUN 
         float angle = currentTime * cycleSpeed;
         float tiltAngle = radians(45.0f);
@@ -1373,6 +1628,25 @@ void mainLoop() {
             camera->update();
         }
 
+        // C. Hand finished path searches to the units (capped so a burst spreads over
+        // frames) and advance a pending landmark rebuild. Both budgets are per rendered
+        // frame, so this runs once here rather than in every step of a catch-up frame
+        if (pathService) pathService->applyResults(PATH_RESULTS_PER_FRAME);
+        if (pathLandmarks) pathLandmarks->update(LANDMARK_CELLS_PER_FRAME);
+
+        // Fixed-Step Simulation
+        // Whole steps for the time that has passed; the remainder carries over, and
+        // rendering blends each unit between the previous and the latest step by it
+        simAccumulator += dt;
+        int simSteps = 0;
+        while (simAccumulator >= SIM_STEP && simSteps < MAX_SIM_STEPS_PER_FRAME) {
+            simulationStep(SIM_STEP);
+            simAccumulator -= SIM_STEP;
+            simSteps++;
+        }
+        if (simAccumulator >= SIM_STEP) simAccumulator = std::fmod(simAccumulator, SIM_STEP); // Drop the backlog
+        simAlpha = simAccumulator / SIM_STEP;
+
         mat4 P = camera->projectionMatrix;
         mat4 V = camera->viewMatrix;
 
@@ -1384,14 +1658,16 @@ void mainLoop() {
         // --- MAGES ---
         std::vector<glm::mat4> mage_IDLE, mage_WALK, mage_ATTACK;
 
-        // 3. Collection Loop
-        for (const auto& u : units) {
-            if (!cameraFrustum.isSphereVisible(u->getPosition(), 3.0f)) continue;
+        // 3. Collection Loop (straight over the hot arrays)
+        const UnitStore& hot = Unit::store();
+        for (size_t u = 0; u < hot.size(); u++) {
+            glm::vec3 pos = hot.renderPosition(u, simAlpha);
+            if (!cameraFrustum.isSphereVisible(pos, 3.0f)) continue;
 
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), u->getPosition());
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), pos);
 
             // Rotation
-            glm::vec3 vel = u->getVelocity();
+            glm::vec3 vel = hot.velocity[u];
             if (glm::length(vel) > 0.1f) {
                 glm::vec3 direction = glm::normalize(vel);
                 float angle = atan2(direction.x, direction.z);
@@ -1404,7 +1680,8 @@ void mainLoop() {
             // 1. Determine Animation State for this unit
             int animState = 0; // 0=IDLE, 1=WALK, 2=ATTACK
 
-            if (u->getState() == UnitState::ATTACKING || u->getState() == UnitState::ATTACKING_BUILDING || u->getState() == UnitState::GATHERING) {
+            UnitState state = hot.state[u];
+            if (state == UnitState::ATTACKING || state == UnitState::ATTACKING_BUILDING || state == UnitState::GATHERING) {
                 animState = 2; // ATTACK
             }
             else if (glm::length(vel) > 0.1f) {
@@ -1415,25 +1692,27 @@ void mainLoop() {
             }
 
             // 2. Push to correct Batch
-            if (u->getType() == UnitType::WORKER) {
+            UnitType type = hot.type[u];
+            if (type == UnitType::WORKER) {
                 if (animState == 2) worker_ATTACK.push_back(model);
                 else if (animState == 1) worker_WALK.push_back(model);
                 else worker_IDLE.push_back(model);
             }
-            else if (u->getType() == UnitType::MELEE) {
+            else if (type == UnitType::MELEE) {
                 if (animState == 2) warrior_ATTACK.push_back(model);
                 else if (animState == 1) warrior_WALK.push_back(model);
                 else warrior_IDLE.push_back(model);
             }
-            else if (u->getType() == UnitType::RANGED) {
+            else if (type == UnitType::RANGED) {
                 if (animState == 2) mage_ATTACK.push_back(model);
                 else if (animState == 1) mage_WALK.push_back(model);
                 else mage_IDLE.push_back(model);
             }
         }
 
-        // C. Camera Override (Unit Camera)
-        if (unitCameraMode && focusedUnit) {
+        // D. Camera Override (Unit Camera)
+        Unit* cameraUnit = Unit::resolve(focusedUnit);
+        if (unitCameraMode && cameraUnit) {
             
             // 1. Handle Q/E Rotation (Only affects this mode)
             float rotSpeed = 2.0f;
@@ -1441,7 +1720,7 @@ void mainLoop() {
             if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) unitCameraAngle += rotSpeed * dt;
 
             // 2. Calculate Orbit Position
-            vec3 uPos = focusedUnit->getPosition();
+            vec3 uPos = cameraUnit->getRenderPosition(simAlpha);
             float dist = 10.0f;
             float height = 6.0f;
 
@@ -1457,144 +1736,12 @@ void mainLoop() {
         } 
         else {
             // Safety: If unit died or deselect, exit mode
-            if (unitCameraMode && !focusedUnit) unitCameraMode = false;
+            if (unitCameraMode && !cameraUnit) unitCameraMode = false;
         }
         cameraFrustum.update(P * V); // Combine Projection and View
 
         updateBuildingPlacement();
 
-        // 1. Remove Dead Units (Clean up the vector)
-        units.erase(std::remove_if(units.begin(), units.end(),
-            [](const std::unique_ptr<Unit>& u) {
-                return u->isDead();
-            }), units.end());
-
-        // 2. Update Remaining Units
-        for (auto& u : units) {
-            u->update(dt, terrain, units, playerResources, environment, navGrid);
-        }
-        
-
-        // -------------------------------------------------------
-        // UPDATE BUILDINGS & AUTO-SPAWN (With Spiral Formation)
-        // -------------------------------------------------------
-        for (auto& b : buildings) {
-            b->updateConstruction(dt);
-
-            UnitType typeToSpawn = b->updateAutoSpawning(dt);
-
-            if ((int)typeToSpawn != -1) {
-
-                // --- 1. Define Rally Point (In Front of Building) ---
-                glm::vec3 buildingPos = b->getPosition();
-
-                //  Calculate "Front" Vector based on Building Rotation (160 degrees)
-                // We convert 160 degrees to radians to get the direction the door is facing.
-                float rotationRadians = glm::radians(160.0f);
-
-                // Assuming the mesh's natural forward is +Z (common for assets)
-                // We rotate the vector (0,0,1) by 160 degrees.
-                float dirX = sin(rotationRadians);
-                float dirZ = cos(rotationRadians);
-
-                glm::vec3 forwardDir(dirX, 0.0f, dirZ);
-
-                // Move the center 30 units out along that direction
-                glm::vec3 rallyCenter = buildingPos + (forwardDir * 10.0f);
-
-                // --- 2. Calculate Spiral Offset ---
-                // Use the number of units spawned so far (1 to 10) as the index 'i'
-                int i = b->getSpawnedCount();
-                float spacing = 3.0f; // Space between units
-
-                // The Spiral Formula:
-                float radius = spacing * std::sqrt(i);
-                float angle = i * 2.4f; // Golden Angle for nice packing
-
-                // Offset relative to the Rally Center
-                glm::vec3 offset(cos(angle) * radius, 0.0f, sin(angle) * radius);
-
-                // Final Target Position
-                glm::vec3 spawnPos = rallyCenter + offset;
-
-                // --- 3. Validate Position ---
-                // Ensure we don't spawn inside a rock or tree
-                if (navGrid && navGrid->isBlocked((int)spawnPos.x, (int)spawnPos.z)) {
-                    spawnPos = Pathfinder::findNearestWalkable((int)spawnPos.x, (int)spawnPos.z, navGrid);
-                }
-
-                // --- 4. Spawn Unit ---
-                if (spawnPos.x != -1.0f) {
-                    auto newUnit = std::make_unique<Unit>(typeToSpawn, spawnPos, b->getTeam());
-
-                    // Optional: Make them physically look away from the building initially
-                    // newUnit->setRotation(160.0f); 
-
-                    units.push_back(std::move(newUnit));
-                }
-            }
-        }
-
-        // -------------------------------------------------------
-        // REMOVE DEAD BUILDINGS
-        // -------------------------------------------------------
-        auto it = buildings.begin();
-        while (it != buildings.end()) {
-            if ((*it)->isDead()) {
-                // Unblock Grid
-                float r = ((*it)->getType() == BuildingType::TOWN_CENTER) ? 12.0f : 8.0f;
-                if (navGrid) {
-                    navGrid->updateArea((*it)->getPosition(), r, false);
-                }
-                std::cout << "Building Destroyed!" << std::endl;
-                it = buildings.erase(it);
-            }
-            else {
-                ++it;
-            }
-        }
-
-        // -------------------------------------------
-        // RIGHT CLICK: Move Selected Units (With Formation)
-        // -------------------------------------------
-        static bool lastRightClick = false;
-        bool rightClick = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
-
-        if (rightClick && !lastRightClick) {
-            vec3 clickPos = getWorldPosUnderCursor();
-
-            // 1. Count selected units to calculate formation size
-            std::vector<Unit*> selectedUnits;
-            for (auto& u : units) {
-                if (u->isSelected()) selectedUnits.push_back(u.get());
-            }
-
-            if (!selectedUnits.empty()) {
-                int count = selectedUnits.size();
-                float spacing = 3.5f; // Distance between units
-
-                for (int i = 0; i < count; i++) {
-                    // 2. Calculate offset (Spiral or Circle formation)
-                    // Simple Circle Strategy:
-                    float radius = spacing * std::sqrt(i + 1);
-                    float angle = i * 2.4f; // Golden angle approx (distributes points evenly)
-
-                    vec3 offset(cos(angle) * radius, 0.0f, sin(angle) * radius);
-                    vec3 unitTarget = clickPos + offset;
-
-                    // 3. Calculate Path for THIS specific unit to its unique target
-                    // (This prevents them from fighting for the same end spot)
-                    std::vector<vec3> path = Pathfinder::findPath(
-                        selectedUnits[i]->getPosition(),
-                        unitTarget,
-                        navGrid // ✅ Now just passing the grid!
-                    );
-                    selectedUnits[i]->setPath(path);
-                }
-            }
-        }
-        lastRightClick = rightClick;
-
         // -------------------------------------------------------
         // 4. SHADOW MAP PASS
         // -------------------------------------------------------
@@ -1771,8 +1918,9 @@ void mainLoop() {
         glEnable(GL_PROGRAM_POINT_SIZE);
         glBindVertexArray(dummyPointVAO);
 
-        for (const auto& u : units) {
-            mat4 model = translate(mat4(1.0f), u->getPosition());
+        const UnitStore& trailUnits = Unit::store();
+        for (size_t u = 0; u < trailUnits.size(); u++) {
+            mat4 model = translate(mat4(1.0f), trailUnits.renderPosition(u, simAlpha));
             model = scale(model, vec3(8.0f));
             glUniformMatrix4fv(glGetUniformLocation(snowTrailShader, "model"), 1, GL_FALSE, &model[0][0]);
             glDrawArrays(GL_POINTS, 0, 1);
@@ -2123,6 +2271,15 @@ void freeResources()
     delete environment; environment = nullptr;
     delete terrain; terrain = nullptr;
     delete camera; camera = nullptr;
+    delete updatePool; updatePool = nullptr;
+    PathRequestService::setActive(nullptr);
+    delete pathService; pathService = nullptr;
+    PathCache::setActive(nullptr);
+    delete pathCache; pathCache = nullptr;
+    Pathfinder::setHierarchy(nullptr);
+    delete pathHierarchy; pathHierarchy = nullptr;
+    Pathfinder::setLandmarks(nullptr);
+    delete pathLandmarks; pathLandmarks = nullptr;
     delete navGrid; navGrid = nullptr;
 
     // 3. Delete OpenGL Resources